@@ -56,7 +56,15 @@ typedef enum {
 	BMP280_ERROR_SENSOR_POLL_TIMEOUT,		/*error in polling timeout. please select a higher timeout*/
 	BMP280_ERROR_NULL_MUTEX_HANDLE,		/*handle to mutex does not exist*/
 	BMP280_ERROR_MODE_UNKNOWN,		/*unknown mode error*/
-	BMP280_ERROR_FILTER_COEFF_UNKNOWN		/*error unknwon filter coeff*/
+	BMP280_ERROR_FILTER_COEFF_UNKNOWN,		/*error unknwon filter coeff*/
+	BMP280_ERROR_PROFILE_UNKNOWN,		/*unknown usage profile*/
+	BMP280_ERROR_MODE_NOT_NORMAL,		/*the operation needs normal mode*/
+	BMP280_ERROR_BUS_MISMATCH,		/*a handle is not attached to the bus*/
+	BMP280_ERROR_WAIT_POLICY_UNKNOWN,		/*unknown wait policy*/
+	BMP280_ERROR_ASYNC_BUSY,		/*an asynchronous operation is still in progress on the storage or the handle*/
+	BMP280_ERROR_MODE_NOT_FORCED,		/*the operation needs forced mode*/
+	BMP280_ERROR_SENSOR_FAULT,		/*the health monitor rejected the sample*/
+	BMP280_ERROR_WAIT_MISMATCH		/*the handles of a batch differ in clock or wait policy*/
 } bmp280_error_code_t;
 
 #ifdef __cplusplus
@@ -65,6 +65,21 @@ int delay_function(uint32_t delayMS)
 	return 0;
 }
 
+/*delayMicroseconds() is only accurate up to 16383 us*/
+int delay_us_function(uint32_t delayUS)
+{
+	delay(delayUS / 1000);
+	delayMicroseconds(delayUS % 1000);
+
+	return 0;
+}
+
+/*micros() wraps around every 71 minutes; the driver only uses differences*/
+uint32_t clock_us(void)
+{
+	return micros();
+}
+
 /*implements a power function (used in altitude calculation)*/
 int power_function(float x, float y, float *result)
 {
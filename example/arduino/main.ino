@@ -17,6 +17,8 @@ void setup() {
   handle.dependency_interface.bmp280_read_array = bmp280_read_array;
   handle.dependency_interface.bmp280_delay_function = delay_function;
   handle.dependency_interface.bmp280_power_function = power_function;
+  handle.dependency_interface.bmp280_clock_us = clock_us;
+  handle.dependency_interface.bmp280_delay_us_function = delay_us_function;
   
   bmp280_error_code_t error = bmp280_init(&handle, BMP280_I2C, BMP280_I2C_ADDRESS_1);
 
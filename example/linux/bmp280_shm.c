@@ -0,0 +1,119 @@
+#include "bmp280_shm.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/*creates (or takes over) the segment and clears all slots*/
+bmp280_shm_t *bmp280_shm_create(const char *name, uint32_t sensor_count)
+{
+	bmp280_shm_t *shm;
+	int fd;
+
+	if(sensor_count == 0 || sensor_count > BMP280_SHM_MAX_SENSORS)
+	{
+		return NULL;
+	}
+
+	fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+	if(fd < 0)
+	{
+		perror("ERROR CREATING SHARED MEMORY");
+		return NULL;
+	}
+
+	if(ftruncate(fd, sizeof(bmp280_shm_t)) != 0)
+	{
+		perror("ERROR SIZING SHARED MEMORY");
+		close(fd);
+		return NULL;
+	}
+
+	shm = mmap(NULL, sizeof(bmp280_shm_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if(shm == MAP_FAILED)
+	{
+		perror("ERROR MAPPING SHARED MEMORY");
+		return NULL;
+	}
+
+	/*readers check the magic last, so the header is complete once it is visible*/
+	shm->magic = 0;
+	atomic_thread_fence(memory_order_release);
+	memset(shm->slots, 0, sizeof(shm->slots));
+	shm->version = BMP280_SHM_VERSION;
+	shm->sample_size = sizeof(bmp280_sensors_data_t);
+	shm->sensor_count = sensor_count;
+	atomic_thread_fence(memory_order_release);
+	shm->magic = BMP280_SHM_MAGIC;
+
+	return shm;
+}
+
+/*seqlock write: odd sequence while the slot is being updated*/
+void bmp280_shm_publish(bmp280_shm_t *shm, uint32_t index, uint8_t i2c_address, bmp280_error_code_t error, const bmp280_sensors_data_t *data)
+{
+	bmp280_shm_slot_t *slot = &shm->slots[index];
+	struct timespec now;
+	uint32_t sequence;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	sequence = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+	atomic_store_explicit(&slot->sequence, sequence + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+
+	slot->i2c_address = i2c_address;
+	slot->error = (int32_t)error;
+	slot->timestamp_ns = (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+	if(data != NULL)
+	{
+		slot->data = *data;
+	}
+
+	atomic_store_explicit(&slot->sequence, sequence + 2, memory_order_release);
+}
+
+int bmp280_shm_destroy(bmp280_shm_t *shm, const char *name)
+{
+	munmap(shm, sizeof(bmp280_shm_t));
+
+	return shm_unlink(name);
+}
+
+/*maps the segment read-only and checks that it was written by a compatible publisher*/
+const bmp280_shm_t *bmp280_shm_open(const char *name)
+{
+	const bmp280_shm_t *shm;
+	int fd;
+
+	fd = shm_open(name, O_RDONLY, 0);
+	if(fd < 0)
+	{
+		perror("ERROR OPENING SHARED MEMORY");
+		return NULL;
+	}
+
+	shm = mmap(NULL, sizeof(bmp280_shm_t), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(shm == MAP_FAILED)
+	{
+		perror("ERROR MAPPING SHARED MEMORY");
+		return NULL;
+	}
+
+	if(shm->magic != BMP280_SHM_MAGIC || shm->version != BMP280_SHM_VERSION || shm->sample_size != sizeof(bmp280_sensors_data_t))
+	{
+		munmap((void *)shm, sizeof(bmp280_shm_t));
+		return NULL;
+	}
+
+	return shm;
+}
+
+int bmp280_shm_close(const bmp280_shm_t *shm)
+{
+	return munmap((void *)shm, sizeof(bmp280_shm_t));
+}
@@ -0,0 +1,93 @@
+#ifndef __BMP280_SHM_H__
+#define __BMP280_SHM_H__
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "bmp280.h"
+
+/*
+ * Latest samples of one or more sensors, published by a single writer (bmp280d) into a POSIX shared-memory segment.
+ * Every slot is guarded by a seqlock: the writer makes the sequence odd while it updates the slot and even once it is done.
+ * Readers never write to the segment and never make a system call after mapping it.
+ * Readers must be built with the same bmp280_config.h as the writer; the header records the sample size to catch a mismatch.
+ */
+
+#define BMP280_SHM_DEFAULT_NAME "/bmp280"
+#define BMP280_SHM_MAGIC 0x42503238
+#define BMP280_SHM_VERSION 1
+#define BMP280_SHM_MAX_SENSORS 8
+
+/*one sensor's latest sample. aligned to a cache line so sensors do not share one*/
+typedef struct
+{
+	_Atomic uint32_t sequence;
+	uint8_t i2c_address;
+	int32_t error;
+	uint64_t timestamp_ns;
+	bmp280_sensors_data_t data;
+} __attribute__((aligned(64))) bmp280_shm_slot_t;
+
+typedef struct
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t sample_size;
+	uint32_t sensor_count;
+	bmp280_shm_slot_t slots[BMP280_SHM_MAX_SENSORS];
+} bmp280_shm_t;
+
+/*a consistent copy of one slot*/
+typedef struct
+{
+	uint32_t sequence;			/*number of samples published in this slot*/
+	uint8_t i2c_address;
+	bmp280_error_code_t error;		/*result of the acquisition of this sample*/
+	uint64_t timestamp_ns;			/*CLOCK_MONOTONIC time of the acquisition*/
+	bmp280_sensors_data_t data;
+} bmp280_shm_sample_t;
+
+/*writer side*/
+bmp280_shm_t *bmp280_shm_create(const char *name, uint32_t sensor_count);
+void bmp280_shm_publish(bmp280_shm_t *shm, uint32_t index, uint8_t i2c_address, bmp280_error_code_t error, const bmp280_sensors_data_t *data);
+int bmp280_shm_destroy(bmp280_shm_t *shm, const char *name);
+
+/*reader side*/
+const bmp280_shm_t *bmp280_shm_open(const char *name);
+int bmp280_shm_close(const bmp280_shm_t *shm);
+
+/*copies the latest sample of a slot, retrying while the writer is in the middle of an update. returns 0 once a sample is available*/
+static inline int bmp280_shm_read(const bmp280_shm_t *shm, uint32_t index, bmp280_shm_sample_t *sample)
+{
+	const bmp280_shm_slot_t *slot;
+	uint32_t sequence_start, sequence_end;
+
+	if(index >= shm->sensor_count)
+	{
+		return 1;
+	}
+
+	slot = &shm->slots[index];
+
+	do
+	{
+		sequence_start = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+		if(sequence_start & 1)
+		{
+			continue;
+		}
+
+		sample->i2c_address = slot->i2c_address;
+		sample->error = (bmp280_error_code_t)slot->error;
+		sample->timestamp_ns = slot->timestamp_ns;
+		sample->data = slot->data;
+
+		atomic_thread_fence(memory_order_acquire);
+		sequence_end = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+	} while((sequence_start & 1) || sequence_start != sequence_end);
+
+	sample->sequence = sequence_start / 2;
+
+	return (sample->sequence == 0) ? 2 : 0;
+}
+
+#endif
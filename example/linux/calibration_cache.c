@@ -0,0 +1,61 @@
+#include "calibration_cache.h"
+#include <stdio.h>
+#include <string.h>
+
+/*reads the cache file. a missing or truncated file leaves an empty cache, which forces a cold start*/
+int bmp280_cache_load(const char *path, bmp280_warm_start_cache_t *cache)
+{
+	FILE *file = fopen(path, "rb");
+
+	memset(cache, 0, sizeof(*cache));
+
+	if(file == NULL)
+	{
+		return 1;
+	}
+
+	if(fread(cache, sizeof(*cache), 1, file) != 1)
+	{
+		memset(cache, 0, sizeof(*cache));
+		fclose(file);
+		return 2;
+	}
+
+	fclose(file);
+
+	return 0;
+}
+
+/*writes a temporary file and renames it, so a crash never leaves a half written cache*/
+int bmp280_cache_save(const char *path, const bmp280_warm_start_cache_t *cache)
+{
+	char temporary_path[256];
+	FILE *file;
+
+	if(snprintf(temporary_path, sizeof(temporary_path), "%s.tmp", path) >= (int)sizeof(temporary_path))
+	{
+		return 1;
+	}
+
+	file = fopen(temporary_path, "wb");
+	if(file == NULL)
+	{
+		perror("ERROR OPENING CACHE FILE");
+		return 2;
+	}
+
+	if(fwrite(cache, sizeof(*cache), 1, file) != 1 || fclose(file) != 0)
+	{
+		perror("ERROR WRITING CACHE FILE");
+		remove(temporary_path);
+		return 3;
+	}
+
+	if(rename(temporary_path, path) != 0)
+	{
+		perror("ERROR RENAMING CACHE FILE");
+		return 4;
+	}
+
+	return 0;
+}
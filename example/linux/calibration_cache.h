@@ -0,0 +1,10 @@
+#ifndef __CALIBRATION_CACHE_H__
+#define __CALIBRATION_CACHE_H__
+
+#include "bmp280.h"
+
+/*keeps a bmp280_warm_start_cache_t in a file, so a restarted process can adopt a running sensor*/
+int bmp280_cache_load(const char *path, bmp280_warm_start_cache_t *cache);
+int bmp280_cache_save(const char *path, const bmp280_warm_start_cache_t *cache);
+
+#endif
@@ -0,0 +1,351 @@
+#include "capture.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*I2C_M_RD flag of the Linux I2C pseudo-header*/
+#define CAPTURE_FLAG_READ 0x00000001
+
+typedef struct
+{
+	uint32_t magic_number;
+	uint16_t version_major;
+	uint16_t version_minor;
+	int32_t thiszone;
+	uint32_t sigfigs;
+	uint32_t snaplen;
+	uint32_t network;
+} pcap_file_header_t;
+
+typedef struct
+{
+	uint32_t ts_sec;
+	uint32_t ts_usec;
+	uint32_t incl_len;
+	uint32_t orig_len;
+} pcap_record_header_t;
+
+static const uint32_t pcap_magic_number = 0xA1B2C3D4;
+
+static FILE *capture_file;
+static uint8_t capture_bus_number;
+static uint8_t *capture_buffer;
+static size_t capture_buffer_size;
+static size_t capture_buffer_used;
+static uint32_t capture_dropped;
+static bmp280_read_array_fp capture_read_array;
+static bmp280_write_array_fp capture_write_array;
+
+static uint8_t *replay_data;
+static size_t replay_size;
+static size_t replay_offset;
+
+/*appends one pcap record to the capture buffer. never touches the file*/
+static void capture_record(const struct timespec *timestamp, uint8_t deviceAddress, uint32_t flags, const uint8_t *prefix, uint8_t prefixLength, const uint8_t *data, uint8_t dataLength)
+{
+	pcap_record_header_t record;
+	uint8_t *position;
+	size_t record_length = BMP280_CAPTURE_RECORD_OVERHEAD + prefixLength + dataLength;
+
+	if(capture_buffer == NULL)
+	{
+		return;
+	}
+
+	if(capture_buffer_used + record_length > capture_buffer_size)
+	{
+		capture_dropped++;
+		return;
+	}
+
+	record.ts_sec = (uint32_t)timestamp->tv_sec;
+	record.ts_usec = (uint32_t)(timestamp->tv_nsec / 1000);
+	record.incl_len = (uint32_t)(record_length - sizeof(pcap_record_header_t));
+	record.orig_len = record.incl_len;
+
+	position = &capture_buffer[capture_buffer_used];
+	memcpy(position, &record, sizeof(record));
+	position += sizeof(record);
+
+	/*pseudo-header: bus number, then the message flags in big endian*/
+	*position++ = capture_bus_number & 0x7F;
+	*position++ = (uint8_t)(flags >> 24);
+	*position++ = (uint8_t)(flags >> 16);
+	*position++ = (uint8_t)(flags >> 8);
+	*position++ = (uint8_t)flags;
+
+	*position++ = (uint8_t)((deviceAddress << 1) | ((flags & CAPTURE_FLAG_READ) ? 1 : 0));
+	if(prefixLength > 0)
+	{
+		memcpy(position, prefix, prefixLength);
+		position += prefixLength;
+	}
+	if(dataLength > 0)
+	{
+		memcpy(position, data, dataLength);
+	}
+
+	capture_buffer_used += record_length;
+}
+
+/*opens the capture file, writes the pcap header and arms the in-memory buffer*/
+int bmp280_capture_start(const char *path, uint8_t bus_number, uint8_t *buffer, size_t buffer_size, bmp280_read_array_fp read_array, bmp280_write_array_fp write_array)
+{
+	pcap_file_header_t header = {pcap_magic_number, 2, 4, 0, 0, 65535, BMP280_CAPTURE_LINKTYPE_I2C_LINUX};
+
+	if(buffer == NULL || read_array == NULL || write_array == NULL)
+	{
+		return 1;
+	}
+
+	capture_file = fopen(path, "wb");
+	if(capture_file == NULL)
+	{
+		perror("ERROR OPENING CAPTURE FILE");
+		return 2;
+	}
+
+	if(fwrite(&header, sizeof(header), 1, capture_file) != 1)
+	{
+		perror("ERROR WRITING CAPTURE FILE");
+		fclose(capture_file);
+		capture_file = NULL;
+		return 3;
+	}
+
+	capture_bus_number = bus_number;
+	capture_buffer = buffer;
+	capture_buffer_size = buffer_size;
+	capture_buffer_used = 0;
+	capture_dropped = 0;
+	capture_read_array = read_array;
+	capture_write_array = write_array;
+
+	return 0;
+}
+
+/*register read: recorded as a one byte write of the register address followed by the read message*/
+int bmp280_capture_read_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
+{
+	struct timespec request_time, response_time;
+	int error;
+
+	clock_gettime(CLOCK_REALTIME, &request_time);
+	error = capture_read_array(deviceAddress, startRegisterAddress, data, dataLength);
+	clock_gettime(CLOCK_REALTIME, &response_time);
+
+	/*a failed read is left out entirely: half a transaction would shift every later one in a replay*/
+	if(error == 0)
+	{
+		capture_record(&request_time, deviceAddress, 0, &startRegisterAddress, 1, NULL, 0);
+		capture_record(&response_time, deviceAddress, CAPTURE_FLAG_READ, NULL, 0, data, dataLength);
+	}
+
+	return error;
+}
+
+/*register write: recorded as a single write message of the register address and data, once it succeeded*/
+int bmp280_capture_write_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
+{
+	struct timespec request_time;
+	int error;
+
+	clock_gettime(CLOCK_REALTIME, &request_time);
+	error = capture_write_array(deviceAddress, startRegisterAddress, data, dataLength);
+
+	if(error == 0)
+	{
+		capture_record(&request_time, deviceAddress, 0, &startRegisterAddress, 1, data, dataLength);
+	}
+
+	return error;
+}
+
+/*writes the buffered records to the file. call it outside of the timing critical path*/
+int bmp280_capture_flush(void)
+{
+	if(capture_file == NULL)
+	{
+		return 1;
+	}
+
+	if(capture_buffer_used > 0 && fwrite(capture_buffer, capture_buffer_used, 1, capture_file) != 1)
+	{
+		perror("ERROR WRITING CAPTURE FILE");
+		return 2;
+	}
+
+	capture_buffer_used = 0;
+
+	if(fflush(capture_file) != 0)
+	{
+		return 3;
+	}
+
+	return 0;
+}
+
+/*flushes the remaining records and closes the capture file*/
+int bmp280_capture_stop(void)
+{
+	int error = bmp280_capture_flush();
+
+	if(capture_file != NULL)
+	{
+		fclose(capture_file);
+		capture_file = NULL;
+	}
+
+	capture_buffer = NULL;
+
+	return error;
+}
+
+uint32_t bmp280_capture_dropped_records(void)
+{
+	return capture_dropped;
+}
+
+/*loads the whole capture into memory and checks its header*/
+int bmp280_replay_open(const char *path)
+{
+	pcap_file_header_t header;
+	FILE *file;
+	long size;
+
+	file = fopen(path, "rb");
+	if(file == NULL)
+	{
+		perror("ERROR OPENING REPLAY FILE");
+		return 1;
+	}
+
+	if(fseek(file, 0, SEEK_END) != 0 || (size = ftell(file)) < (long)sizeof(header) || fseek(file, 0, SEEK_SET) != 0)
+	{
+		fclose(file);
+		return 2;
+	}
+
+	replay_data = malloc((size_t)size);
+	if(replay_data == NULL || fread(replay_data, (size_t)size, 1, file) != 1)
+	{
+		free(replay_data);
+		replay_data = NULL;
+		fclose(file);
+		return 3;
+	}
+	fclose(file);
+
+	memcpy(&header, replay_data, sizeof(header));
+	if(header.magic_number != pcap_magic_number || header.network != BMP280_CAPTURE_LINKTYPE_I2C_LINUX)
+	{
+		bmp280_replay_close();
+		return 4;
+	}
+
+	replay_size = (size_t)size;
+	replay_offset = sizeof(header);
+
+	return 0;
+}
+
+int bmp280_replay_close(void)
+{
+	free(replay_data);
+	replay_data = NULL;
+	replay_size = 0;
+	replay_offset = 0;
+
+	return 0;
+}
+
+/*returns the payload of the next record if its direction and address match, NULL otherwise*/
+static const uint8_t *replay_next_message(uint8_t deviceAddress, uint32_t flags, uint32_t *payloadLength)
+{
+	pcap_record_header_t record;
+	const uint8_t *message;
+	uint32_t message_flags;
+
+	if(replay_data == NULL || replay_offset + sizeof(record) > replay_size)
+	{
+		return NULL;
+	}
+
+	memcpy(&record, &replay_data[replay_offset], sizeof(record));
+	if(record.incl_len < 6 || replay_offset + sizeof(record) + record.incl_len > replay_size)
+	{
+		return NULL;
+	}
+
+	message = &replay_data[replay_offset + sizeof(record)];
+	message_flags = ((uint32_t)message[1] << 24) | ((uint32_t)message[2] << 16) | ((uint32_t)message[3] << 8) | (uint32_t)message[4];
+
+	if((message_flags & CAPTURE_FLAG_READ) != flags || (message[5] >> 1) != deviceAddress)
+	{
+		return NULL;
+	}
+
+	replay_offset += sizeof(record) + record.incl_len;
+	*payloadLength = record.incl_len - 6;
+
+	return &message[6];
+}
+
+int bmp280_replay_init(uint8_t deviceAddress)
+{
+	(void)deviceAddress;
+
+	return (replay_data == NULL) ? 1 : 0;
+}
+
+int bmp280_replay_deinit(uint8_t deviceAddress)
+{
+	(void)deviceAddress;
+
+	return 0;
+}
+
+int bmp280_replay_read_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
+{
+	const uint8_t *payload;
+	uint32_t payload_length;
+
+	payload = replay_next_message(deviceAddress, 0, &payload_length);
+	if(payload == NULL || payload_length != 1 || payload[0] != startRegisterAddress)
+	{
+		return 1;
+	}
+
+	payload = replay_next_message(deviceAddress, CAPTURE_FLAG_READ, &payload_length);
+	if(payload == NULL || payload_length != dataLength)
+	{
+		return 2;
+	}
+
+	memcpy(data, payload, dataLength);
+
+	return 0;
+}
+
+int bmp280_replay_write_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
+{
+	const uint8_t *payload;
+	uint32_t payload_length;
+
+	payload = replay_next_message(deviceAddress, 0, &payload_length);
+	if(payload == NULL || payload_length != (uint32_t)dataLength + 1 || payload[0] != startRegisterAddress || memcmp(&payload[1], data, dataLength) != 0)
+	{
+		return 1;
+	}
+
+	return 0;
+}
+
+/*time is not reproduced in a replay, the recorded register values already carry the outcome*/
+int bmp280_replay_delay_function(uint32_t delayMS)
+{
+	(void)delayMS;
+
+	return 0;
+}
@@ -0,0 +1,39 @@
+#ifndef __CAPTURE_H__
+#define __CAPTURE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "bmp280.h"
+
+/*link type of Linux I2C captures in the pcap link-layer header registry*/
+#define BMP280_CAPTURE_LINKTYPE_I2C_LINUX 209
+
+/*pcap record header + I2C pseudo-header (bus, flags) + address byte*/
+#define BMP280_CAPTURE_RECORD_OVERHEAD (16 + 5 + 1)
+
+/*
+ * Capture: wraps the transport read/write functions and records every transaction into a caller supplied buffer.
+ * Records are kept in pcap format in memory and only written to the file on bmp280_capture_flush() or bmp280_capture_stop(),
+ * so the hot path costs one clock read and one memcpy. When the buffer is full, records are dropped and counted.
+ * Failed transfers are not recorded: the pcap holds only transactions that completed, so a replay returns success for them.
+ */
+int bmp280_capture_start(const char *path, uint8_t bus_number, uint8_t *buffer, size_t buffer_size, bmp280_read_array_fp read_array, bmp280_write_array_fp write_array);
+int bmp280_capture_read_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength);
+int bmp280_capture_write_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength);
+int bmp280_capture_flush(void);
+int bmp280_capture_stop(void);
+uint32_t bmp280_capture_dropped_records(void);
+
+/*
+ * Replay: feeds a capture back into the driver. Every read and write must match the next transaction in the file,
+ * otherwise the call fails. Delays return immediately, so a replay is deterministic.
+ */
+int bmp280_replay_open(const char *path);
+int bmp280_replay_close(void);
+int bmp280_replay_init(uint8_t deviceAddress);
+int bmp280_replay_deinit(uint8_t deviceAddress);
+int bmp280_replay_read_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength);
+int bmp280_replay_write_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength);
+int bmp280_replay_delay_function(uint32_t delayMS);
+
+#endif
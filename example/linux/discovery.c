@@ -0,0 +1,131 @@
+#include "discovery.h"
+#include <glob.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+#define DISCOVERY_MAX_BUSES 64
+/*in units of 10 ms: an absent device must not hold the probe for long*/
+#define DISCOVERY_BUS_TIMEOUT 1
+
+typedef struct
+{
+	char bus_path[32];
+	uint8_t bus_number;
+	uint8_t found_count;
+	bmp280_i2c_address_t found[2];
+} discovery_bus_t;
+
+static const bmp280_i2c_address_t discovery_addresses[] = {BMP280_I2C_ADDRESS_1, BMP280_I2C_ADDRESS_2};
+
+/*reads the chip ID register in one combined transaction (repeated start, no stop in between)*/
+static int discovery_read_chip_id(int fd, uint8_t address, uint8_t *chip_id)
+{
+	uint8_t register_address = BMP280_REGISTER_ADDRESS_ID;
+	struct i2c_msg messages[2] = {
+		{address, 0, 1, &register_address},
+		{address, I2C_M_RD, 1, chip_id}};
+	struct i2c_rdwr_ioctl_data transfer = {messages, 2};
+
+	return (ioctl(fd, I2C_RDWR, &transfer) == 2) ? 0 : 1;
+}
+
+static void *discovery_probe_bus(void *argument)
+{
+	discovery_bus_t *bus = (discovery_bus_t *)argument;
+	int fd = open(bus->bus_path, O_RDWR);
+
+	if(fd < 0)
+	{
+		return NULL;
+	}
+
+	ioctl(fd, I2C_TIMEOUT, DISCOVERY_BUS_TIMEOUT);
+	ioctl(fd, I2C_RETRIES, 0);
+
+	for(uint8_t index = 0; index < sizeof(discovery_addresses) / sizeof(discovery_addresses[0]); index++)
+	{
+		uint8_t chip_id;
+
+		if(discovery_read_chip_id(fd, (uint8_t)discovery_addresses[index], &chip_id) == 0 && chip_id == BMP280_DEFAULT_CHIP_ID)
+		{
+			bus->found[bus->found_count++] = discovery_addresses[index];
+		}
+	}
+
+	close(fd);
+
+	return NULL;
+}
+
+static int discovery_compare_buses(const void *first, const void *second)
+{
+	return (int)((const discovery_bus_t *)first)->bus_number - (int)((const discovery_bus_t *)second)->bus_number;
+}
+
+int bmp280_discover(bmp280_device_descriptor_t *devices, int max_devices)
+{
+	discovery_bus_t buses[DISCOVERY_MAX_BUSES];
+	pthread_t threads[DISCOVERY_MAX_BUSES];
+	uint8_t started[DISCOVERY_MAX_BUSES];
+	glob_t adapters;
+	size_t bus_count;
+	int device_count = 0;
+
+	if(glob("/dev/i2c-*", 0, NULL, &adapters) != 0)
+	{
+		return 0;
+	}
+
+	bus_count = (adapters.gl_pathc < DISCOVERY_MAX_BUSES) ? adapters.gl_pathc : DISCOVERY_MAX_BUSES;
+
+	for(size_t index = 0; index < bus_count; index++)
+	{
+		unsigned int bus_number = 0;
+
+		memset(&buses[index], 0, sizeof(buses[index]));
+		snprintf(buses[index].bus_path, sizeof(buses[index].bus_path), "%s", adapters.gl_pathv[index]);
+		sscanf(buses[index].bus_path, "/dev/i2c-%u", &bus_number);
+		buses[index].bus_number = (uint8_t)bus_number;
+	}
+	globfree(&adapters);
+
+	/*one thread per adapter: every bus waits for its own timeouts in parallel*/
+	for(size_t index = 0; index < bus_count; index++)
+	{
+		started[index] = (pthread_create(&threads[index], NULL, discovery_probe_bus, &buses[index]) == 0);
+		if(!started[index])
+		{
+			discovery_probe_bus(&buses[index]);
+		}
+	}
+
+	for(size_t index = 0; index < bus_count; index++)
+	{
+		if(started[index])
+		{
+			pthread_join(threads[index], NULL);
+		}
+	}
+
+	qsort(buses, bus_count, sizeof(buses[0]), discovery_compare_buses);
+
+	for(size_t index = 0; index < bus_count; index++)
+	{
+		for(uint8_t found = 0; found < buses[index].found_count && device_count < max_devices; found++)
+		{
+			memcpy(devices[device_count].bus_path, buses[index].bus_path, sizeof(devices[device_count].bus_path));
+			devices[device_count].bus_number = buses[index].bus_number;
+			devices[device_count].i2c_address = buses[index].found[found];
+			device_count++;
+		}
+	}
+
+	return device_count;
+}
@@ -0,0 +1,18 @@
+#ifndef __DISCOVERY_H__
+#define __DISCOVERY_H__
+
+#include <stdint.h>
+#include "bmp280.h"
+
+/*everything needed to initialize a discovered sensor: select the bus with bmp280_i2c_set_bus_path(), then bmp280_init() with the address*/
+typedef struct
+{
+	char bus_path[32];
+	uint8_t bus_number;
+	bmp280_i2c_address_t i2c_address;
+} bmp280_device_descriptor_t;
+
+/*probes every /dev/i2c-* adapter in parallel for a BMP280 chip ID at both addresses. returns the number of sensors found, sorted by bus and address*/
+int bmp280_discover(bmp280_device_descriptor_t *devices, int max_devices);
+
+#endif
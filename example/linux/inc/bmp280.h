@@ -60,6 +60,68 @@ bmp280_error_code_t bmp280_init(
 	bmp280_i2c_address_t i2c_address);
 
 
+/**
+ * @brief BMP280 initializer for several sensors
+ * 
+ * Same as bmp280_init() for each sensor, but the waiting phases overlap: all sensors are
+ * reset, the startup delay is waited once, then the calibrations are read back-to-back and
+ * all sensors are configured. A sensor that fails a step is left out of the later steps and
+ * the others are still initialized; errors tells which sensors failed.
+ * 
+ * @param handles: Array of pointers to the BMP280 instance handle structures.
+ * @param hw_interface: Defines which hardware interface is used: I2C, SPI or a software mock.
+ * @param i2c_addresses: I2C address of each sensor in case of I2C interface.
+ * @param count: Number of sensors.
+ * @param errors: Result of each sensor, 0 or ERROR_OK for the ones that are initialized.
+ * @return 0 or ERROR_OK if all sensors are initialized, otherwise the error of the first one that failed.
+ */
+bmp280_error_code_t bmp280_init_multiple(
+	bmp280_handle_t *handles[], 
+	bmp280_hardware_interface_t hw_interface, 
+	const bmp280_i2c_address_t i2c_addresses[],
+	uint8_t count,
+	bmp280_error_code_t errors[]);
+
+#if BMP280_INCLUDE_WARM_START
+
+/**
+ * @brief BMP280 warm start initializer
+ * 
+ * Adopts a sensor that is already running, without a reset: checks the chip ID, reads the
+ * calibration and ctrl_meas/config and compares them with the cache. If anything differs
+ * (e.g. the sensor was power cycled), falls back to a full bmp280_init() and refreshes the cache.
+ * A forced mode sensor reads back sleep mode between conversions; it is adopted in forced mode
+ * if the cache says so and the rest of ctrl_meas matches.
+ * 
+ * @param handle: Pointer to the BMP280 instance handle structure.
+ * @param hw_interface: Defines which hardware interface is used: I2C, SPI or a software mock.
+ * @param i2c_address: I2C address in case of I2C interface.
+ * @param cache: Pointer to the warm start cache, updated on a cold start.
+ * @return 0 or ERROR_OK on success, other values on errors.
+ */
+bmp280_error_code_t bmp280_init_warm(
+	bmp280_handle_t *handle, 
+	bmp280_hardware_interface_t hw_interface, 
+	bmp280_i2c_address_t i2c_address,
+	bmp280_warm_start_cache_t *cache);
+
+
+/**
+ * @brief BMP280 save warm start cache
+ * 
+ * Stores the calibration and the current ctrl_meas/config of the sensor in the cache.
+ * Call it once the sensor is configured.
+ * 
+ * @param handle: Pointer to the BMP280 instance handle structure.
+ * @param cache: Pointer to the warm start cache.
+ * @return 0 or ERROR_OK on success, other values on errors.
+ */
+bmp280_error_code_t bmp280_save_warm_start_cache(
+	bmp280_handle_t *handle, 
+	bmp280_warm_start_cache_t *cache);
+#endif
+
+
 /**
  * @brief BMP280 deinitializer
  * 
@@ -69,6 +131,20 @@ bmp280_error_code_t bmp280_init(
 bmp280_error_code_t bmp280_deinit(bmp280_handle_t *handle);
 
 
+/**
+ * @brief BMP280 reinitializer
+ * 
+ * Brings back a sensor that was initialized before, e.g. after bus errors or a brown-out,
+ * without the reset, startup delay and calibration read of bmp280_init(): checks the chip ID,
+ * reads ctrl_meas/config and, if the sensor lost them, writes them again from the handle. The
+ * calibration in the handle is kept. The interface must be working again.
+ * 
+ * @param handle: Pointer to the BMP280 instance handle structure.
+ * @return 0 or ERROR_OK on success, other values on errors.
+ */
+bmp280_error_code_t bmp280_reinit(bmp280_handle_t *handle);
+
+
 /**
  * @brief BMP280 chip ID checker
  * 
@@ -161,6 +237,87 @@ bmp280_error_code_t bmp280_set_filter_coefficient(
 	bmp280_iir_filter_t filterCoefficient);
 
 
+/**
+ * @brief BMP280 set settings
+ * 
+ * Sets mode, oversampling, standby time and filter coefficient together: config and
+ * ctrl_meas are written once each, with a write to sleep mode first only if the sensor
+ * is not already sleeping.
+ * 
+ * @param handle: Pointer to the BMP280 instance handle structure.
+ * @param settings: Pointer to the new settings.
+ * @return 0 or ERROR_OK on success, other values on errors.
+ */
+bmp280_error_code_t bmp280_set_settings(
+	bmp280_handle_t *handle, 
+	const bmp280_settings_t *settings);
+
+
+/**
+ * @brief BMP280 set profile
+ * 
+ * Applies the settings of a usage profile (see BMP280_PROFILES) with bmp280_set_settings()
+ * 
+ * @param handle: Pointer to the BMP280 instance handle structure.
+ * @param profile: One of the usage profiles of the datasheet.
+ * @return 0 or ERROR_OK on success, other values on errors.
+ */
+bmp280_error_code_t bmp280_set_profile(
+	bmp280_handle_t *handle, 
+	bmp280_usage_profile_t profile);
+
+
+/**
+ * @brief BMP280 set wait policy
+ * 
+ * Selects how the end of a conversion is waited for. BMP280_WAIT_SLEEP (the default) sleeps
+ * for the maximum measurement time. BMP280_WAIT_SLEEP_THEN_SPIN sleeps until spinMarginUs
+ * before the typical measurement time and spins on the clock for the rest;
+ * BMP280_WAIT_SPIN spins all the way. Both then poll the status register back to back, so
+ * the sample is read within a bus transfer of the end of the conversion, at the cost of CPU
+ * time and bus traffic. The spinning policies need the clock dependency.
+ * 
+ * @param handle: Pointer to the BMP280 instance handle structure.
+ * @param policy: The wait policy.
+ * @param spinMarginUs: BMP280_WAIT_SLEEP_THEN_SPIN: time to spin instead of sleeping, at least the oversleep of the delay function.
+ * @return 0 or ERROR_OK on success, other values on errors.
+ */
+bmp280_error_code_t bmp280_set_wait_policy(
+	bmp280_handle_t *handle, 
+	bmp280_wait_policy_t policy,
+	uint16_t spinMarginUs);
+
+
+/**
+ * @brief BMP280 get timing
+ * 
+ * Returns the measurement times, sample period and output data rate of the current
+ * configuration. Uses the last written register values, no bus access.
+ * 
+ * @param handle: Pointer to the BMP280 instance handle structure.
+ * @param timing: Pointer to the timing.
+ * @return 0 or ERROR_OK on success, other values on errors.
+ */
+bmp280_error_code_t bmp280_get_timing(
+	bmp280_handle_t *handle, 
+	bmp280_timing_t *timing);
+
+
+/**
+ * @brief BMP280 calculate timing
+ * 
+ * Same as bmp280_get_timing() for any settings, e.g. to plan the bus load of many sensors
+ * before configuring them.
+ * 
+ * @param settings: Pointer to the settings.
+ * @param timing: Pointer to the timing.
+ * @return 0 or ERROR_OK on success, other values on errors.
+ */
+bmp280_error_code_t bmp280_calculate_timing(
+	const bmp280_settings_t *settings, 
+	bmp280_timing_t *timing);
+
+
 /**
  * @brief BMP280 get temperature
  * 
@@ -188,6 +345,58 @@ bmp280_error_code_t bmp280_get_pressure(
 	bmp280_handle_t *handle, 
 	uint32_t *pressure);
 
+#if BMP280_INCLUDE_SCHEDULER
+
+/**
+ * @brief BMP280 scheduler init
+ * 
+ * Prepares a read scheduler for a sensor in normal mode. Call it again after changing
+ * the configuration.
+ * 
+ * @param handle: Pointer to the BMP280 instance handle structure.
+ * @param scheduler: Pointer to the scheduler state.
+ * @param now_us: Current time of the application's microsecond clock.
+ * @return 0 or ERROR_OK on success, other values on errors.
+ */
+bmp280_error_code_t bmp280_scheduler_init(
+	bmp280_handle_t *handle, 
+	bmp280_scheduler_t *scheduler, 
+	uint32_t now_us);
+
+
+/**
+ * @brief BMP280 scheduler get all
+ * 
+ * Reads the sensor only if a conversion has completed since the last read: status and all
+ * data in one burst. Before the next conversion is due it returns the last sample without a
+ * bus access and with data->new_data cleared. The conversion phase is found and kept in sync
+ * with the measuring bit of the status register.
+ * 
+ * @param handle: Pointer to the BMP280 instance handle structure.
+ * @param scheduler: Pointer to the scheduler state.
+ * @param now_us: Current time of the application's microsecond clock.
+ * @param data: An structure of temperature, pressure and (optional) altitude
+ * @return 0 or ERROR_OK on success, other values on errors.
+ */
+bmp280_error_code_t bmp280_scheduler_get_all(
+	bmp280_handle_t *handle, 
+	bmp280_scheduler_t *scheduler, 
+	uint32_t now_us, 
+	bmp280_sensors_data_t *data);
+
+
+/**
+ * @brief BMP280 scheduler next read
+ * 
+ * Returns when to call bmp280_scheduler_get_all() next: just after the next conversion
+ * completes, or the next poll while the phase is still being searched.
+ * 
+ * @param scheduler: Pointer to the scheduler state.
+ * @return Time of the next read, in the application's microsecond clock.
+ */
+uint32_t bmp280_scheduler_next_read_us(const bmp280_scheduler_t *scheduler);
+#endif
+
 #if BMP280_INCLUDE_ALTITUDE 
 
 /**
@@ -228,7 +437,9 @@ bmp280_error_code_t bmp280_calculate_altitude_hypsometric(
 /**
  * @brief BMP280 get temperature and pressure (optional: altitude)
  * 
- * Returns a complete set of sensor readings and altitude calculation (quick)
+ * Returns a complete set of sensor readings and altitude calculation (quick), from one
+ * burst read. If the raw registers did not change since the last call, the cached result is
+ * returned without any calculation and, in normal mode, data->new_data is 0.
  * 
  * @param handle: Pointer to the BMP280 instance handle structure.
  * @param alt: Pointer to altitude value.
@@ -236,9 +447,175 @@ bmp280_error_code_t bmp280_calculate_altitude_hypsometric(
  * @return 0 or ERROR_OK on success, other values on errors.
  */	
 bmp280_error_code_t bmp280_get_all(
-	bmp280_handle_t *handle, 
+	bmp280_handle_t *handle,
 	bmp280_sensors_data_t *data);
 
+/**
+ * @brief BMP280 get temperature and pressure, pipelined (forced mode)
+ *
+ * Like bmp280_get_all(), but in forced mode the next conversion is started right after the
+ * data registers are read, before compensation. The sensor converts while the application
+ * works, and the next call finds the sample ready instead of waiting for it. Each sample is
+ * taken when the previous call returned, not when this call is made. The first call, and the
+ * first call after any settings change, trigger and wait like bmp280_get_all(). In other modes
+ * it is the same as bmp280_get_all().
+ *
+ * @param handle: Pointer to the BMP280 instance handle structure.
+ * @param data: An structure of temperature, pressure and (optional) altitude
+ * @return 0 or ERROR_OK on success, other values on errors.
+ */
+bmp280_error_code_t bmp280_get_all_pipelined(
+	bmp280_handle_t *handle,
+	bmp280_sensors_data_t *data);
+
+/**
+ * @brief BMP280 get temperature and pressure of several sensors
+ *
+ * Like bmp280_get_all() for each handle, but the forced mode sensors are triggered first and
+ * waited for once, for the longest maximum measurement time among them, before all sensors are
+ * read. A frame takes about one conversion instead of the sum of all conversions. Sensors in
+ * normal mode are read without a trigger. All handles must share the clock dependency and the
+ * wait policy, which the single wait uses. A sample rejected by the health monitor does not stop
+ * the frame: the other sensors are still read, a due reset runs as in bmp280_get_all(), and
+ * BMP280_ERROR_SENSOR_FAULT is returned at the end.
+ *
+ * @param handles: Array of handle pointers.
+ * @param data: Array of sensor data, one per handle.
+ * @param count: Number of handles.
+ * @return 0 or ERROR_OK on success, other values on errors.
+ */
+bmp280_error_code_t bmp280_get_all_multiple(
+	bmp280_handle_t *handles[],
+	bmp280_sensors_data_t data[],
+	uint8_t count);
+
+#if BMP280_INCLUDE_SHARED_BUS
+
+/**
+ * @brief BMP280 get all sensors of a shared bus
+ *
+ * Reads the latest sample of several sensors in normal mode back to back, under one hold of
+ * the bus lock, and compensates each like bmp280_get_all().
+ *
+ * @param bus: Pointer to the bus the handles are attached to.
+ * @param handles: Array of handle pointers, all with handle->bus set to bus.
+ * @param data: Array of sensor data, one per handle.
+ * @param count: Number of handles.
+ * @return 0 or ERROR_OK on success, other values on errors.
+ */
+bmp280_error_code_t bmp280_bus_get_all(
+	bmp280_bus_t *bus,
+	bmp280_handle_t *handles[],
+	bmp280_sensors_data_t data[],
+	uint8_t count);
+
+#endif
+
+#if BMP280_INCLUDE_ASYNC
+
+/**
+ * @brief BMP280 get temperature and pressure, asynchronously
+ *
+ * Starts the steps of bmp280_get_all() on the asynchronous transport and returns: in forced
+ * mode the trigger, a timer for the maximum measurement time, then (in every mode) the
+ * status read, timers of the poll period while measuring, and the data read. Each step is
+ * submitted from the completion of the one before; done is called from the completion of
+ * the last one, or of the one that failed. The completions take the exclusion hook (the bus
+ * lock on a shared bus) around their use of the handle and count the transfers in the bus
+ * statistics, so they must run where the hook may be taken; it is never held across a
+ * submission. The transport serializes its transfers with any other transport of the bus.
+ * A second operation on the same handle returns BMP280_ERROR_ASYNC_BUSY until done is
+ * called. The sensor must be initialized with bmp280_init() first.
+ *
+ * @param handle: Pointer to the BMP280 instance handle structure.
+ * @param operation: Storage of the operation, zeroed before its first use, valid until done.
+ * @param data: Sensor data, valid when done reports no error.
+ * @param done: Called once with the result, unless this call returns an error.
+ * @param context: Passed to done.
+ * @return 0 or ERROR_OK if the operation started, other values on errors.
+ */
+bmp280_error_code_t bmp280_get_all_async(
+	bmp280_handle_t *handle,
+	bmp280_async_operation_t *operation,
+	bmp280_sensors_data_t *data,
+	bmp280_async_done_fp done,
+	void *context);
+
+#endif
+
+#if BMP280_INCLUDE_HEALTH_MONITOR
+
+/**
+ * @brief BMP280 set health monitor
+ *
+ * Turns on the checks of every sample read: data registers holding 0x80000 (a reset sensor
+ * or a skipped conversion), normal mode data registers that stay unchanged for stuck_limit
+ * reads, ctrl_meas/config that differ from the values last written, and pressure or
+ * temperature steps beyond the slew limits (a step is accepted once the next sample
+ * confirms it). The checks use the bytes a read transfers anyway; ctrl_meas and config are
+ * read after a fault or every register_check_interval samples, and compared on every
+ * bmp280_scheduler_get_all(), whose burst holds them. A rejected sample returns
+ * BMP280_ERROR_SENSOR_FAULT with the data filled in. With auto_recover, lost settings are
+ * written again, and a sensor that stays faulty is soft reset by bmp280_get_all(),
+ * bmp280_get_all_pipelined() or bmp280_health_recover().
+ *
+ * @param handle: Pointer to the BMP280 instance handle structure.
+ * @param settings: Limits and recovery of the checks, NULL to turn the monitor off.
+ * @return 0 or ERROR_OK on success, other values on errors.
+ */
+bmp280_error_code_t bmp280_set_health_monitor(
+	bmp280_handle_t *handle,
+	const bmp280_health_settings_t *settings);
+
+
+/**
+ * @brief BMP280 get health
+ *
+ * Returns the fault counters of the health monitor, no bus access.
+ *
+ * @param handle: Pointer to the BMP280 instance handle structure.
+ * @param status: Pointer to the fault counters.
+ * @return 0 or ERROR_OK on success, other values on errors.
+ */
+bmp280_error_code_t bmp280_get_health(
+	bmp280_handle_t *handle,
+	bmp280_health_status_t *status);
+
+
+/**
+ * @brief BMP280 health recover
+ *
+ * Runs the recovery a sample read left due: the ctrl_meas/config check after a fault of an
+ * asynchronous or scheduler read, and the soft reset with the startup delay, after which
+ * ctrl_meas and config are written again from the handle. Does nothing if none is due.
+ *
+ * @param handle: Pointer to the BMP280 instance handle structure.
+ * @return 0 or ERROR_OK on success, other values on errors.
+ */
+bmp280_error_code_t bmp280_health_recover(bmp280_handle_t *handle);
+
+#endif
+
+
+/**
+ * @brief BMP280 set temperature decimation
+ * 
+ * Makes bmp280_get_all() read the temperature (the t_fine input of the pressure
+ * compensation) only every interval samples; the samples in between read the 3 pressure
+ * bytes and reuse the last temperature. If the temperature changed by more than the drift
+ * limit between two temperature reads, the next sample reads it again. A lower temperature
+ * oversampling also shortens every conversion.
+ * 
+ * @param handle: Pointer to the BMP280 instance handle structure.
+ * @param interval: Samples per temperature read, 0 or 1 to read it every time.
+ * @param driftLimit: Largest temperature change between two temperature reads, in 0.01 Centigrade.
+ * @return 0 or ERROR_OK on success, other values on errors.
+ */
+bmp280_error_code_t bmp280_set_temperature_decimation(
+	bmp280_handle_t *handle, 
+	uint8_t interval, 
+	uint16_t driftLimit);
+
 
 /**
  * @brief BMP280 get mode of operation
@@ -308,6 +685,20 @@ bmp280_error_code_t bmp280_get_standby_time(
 bmp280_error_code_t bmp280_get_filter_coefficient(
 	bmp280_handle_t *handle, 
 	bmp280_iir_filter_t *filter_coeff);
+
+
+/**
+ * @brief BMP280 get settings
+ * 
+ * Returns mode, oversampling, standby time and filter coefficient from a single burst read
+ * 
+ * @param handle: Pointer to the BMP280 instance handle structure.
+ * @param settings: Pointer to the settings.
+ * @return 0 or ERROR_OK on success, other values on errors.
+ */
+bmp280_error_code_t bmp280_get_settings(
+	bmp280_handle_t *handle, 
+	bmp280_settings_t *settings);
 #endif
 
 #ifdef __cplusplus
@@ -0,0 +1,203 @@
+/**
+* @file	bmp280_compensation.hpp
+* @brief BMP280 barometric pressure and temperature sensor compile-time math (C++17)
+* @author Reza G. Ebrahimi <https://github.com/ebrezadev>
+* @version 5.0
+* @Section HOW-TO-USE
+* constexpr versions of the integer compensation of bmp280.c, the measurement time formula and
+* the standby time to output data rate mapping of the datasheet (chapter 3.8). With calibration
+* constants known at build time, the whole compensation folds into constants:
+*	@code
+*	constexpr bmp280_calibration_param_t board_dig = {27504, 26435, -1000, 36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000};
+*	static_assert(bmp280::compensate_temperature_centi(board_dig, 519888) == 2508);
+*	@endcode
+* The results are bit-exact with bmp280_get_temperature() and bmp280_get_pressure().
+*
+* @license MIT
+*
+* MIT License
+*
+* Copyright (c) 2025 Reza G. Ebrahimi
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#ifndef __BMP280_COMPENSATION_HPP__
+#define __BMP280_COMPENSATION_HPP__
+
+#include "bmp280_definitions.h"
+#include <cstdint>
+
+namespace bmp280
+{
+
+/**
+ * @brief Fine resolution temperature, input of the pressure compensation
+ *
+ * @param dig: Calibration parameters.
+ * @param adc_T: Raw 20 bit temperature.
+ * @return t_fine.
+ */
+constexpr int32_t compensate_t_fine(const bmp280_calibration_param_t &dig, int32_t adc_T)
+{
+	int32_t var1 = ((((adc_T >> 3) - ((int32_t)dig.T1 << 1))) * ((int32_t)dig.T2)) >> 11;
+	int32_t var2 = (((((adc_T >> 4) - ((int32_t)dig.T1)) * ((adc_T >> 4) - ((int32_t)dig.T1))) >> 12) * ((int32_t)dig.T3)) >> 14;
+
+	return var1 + var2;
+}
+
+/*temperature in 0.01 Centigrade from t_fine*/
+constexpr int32_t temperature_centi_from_t_fine(int32_t t_fine)
+{
+	return (t_fine * 5 + 128) >> 8;
+}
+
+/*temperature in 0.01 Centigrade from the raw value*/
+constexpr int32_t compensate_temperature_centi(const bmp280_calibration_param_t &dig, int32_t adc_T)
+{
+	return temperature_centi_from_t_fine(compensate_t_fine(dig, adc_T));
+}
+
+/*temperature in Centigrade, rounded exactly like bmp280_get_temperature()*/
+constexpr float temperature_from_t_fine(int32_t t_fine)
+{
+	return (float)((float)temperature_centi_from_t_fine(t_fine) / 100.0);
+}
+
+/**
+ * @brief Pressure compensation
+ *
+ * @param dig: Calibration parameters.
+ * @param adc_P: Raw 20 bit pressure.
+ * @param t_fine: Fine temperature of the same measurement.
+ * @return Pressure in Pascal, 0 for an invalid calibration.
+ */
+constexpr uint32_t compensate_pressure(const bmp280_calibration_param_t &dig, int32_t adc_P, int32_t t_fine)
+{
+	int32_t var1 = 0, var2 = 0;
+	uint32_t pressure = 0;
+
+	var1 = (((int32_t)t_fine) / 2) - (int32_t)64000;
+	var2 = (((var1 / 4) * (var1 / 4)) / 2048) * ((int32_t)dig.P6);
+	var2 = var2 + ((var1 * ((int32_t)dig.P5)) * 2);
+	var2 = (var2 / 4) + (((int32_t)dig.P4) * 65536);
+	var1 = (((dig.P3 * (((var1 / 4) * (var1 / 4)) / 8192)) / 8) + ((((int32_t)dig.P2) * var1) / 2)) / 262144;
+	var1 = ((((32768 + var1)) * ((int32_t)dig.P1)) / 32768);
+	pressure = (uint32_t)(((int32_t)(1048576 - adc_P) - (var2 / 4096)) * 3125);
+
+	/*avoid exception caused by division with zero*/
+	if (var1 == 0)
+	{
+		return 0;
+	}
+
+	/*check for overflows against UINT32_MAX/2; if pres is left-shifted by 1*/
+	if (pressure < 0x80000000)
+	{
+		pressure = (pressure << 1) / ((uint32_t)var1);
+	}
+	else
+	{
+		pressure = (pressure / (uint32_t)var1) * 2;
+	}
+	var1 = (((int32_t)dig.P9) * ((int32_t)(((pressure / 8) * (pressure / 8)) / 8192))) / 4096;
+	var2 = (((int32_t)(pressure / 4)) * ((int32_t)dig.P8)) / 8192;
+
+	return (uint32_t)((int32_t)pressure + ((var1 + var2 + dig.P7) / 16));
+}
+
+/*number of samples of an oversampling setting: 0 (skipped), 1, 2, 4, 8 or 16*/
+constexpr uint32_t oversampling_factor(bmp280_over_sampling_t osValue)
+{
+	return (osValue == BMP280_OVERSAMPLING_0X) ? 0 : (1u << ((uint32_t)osValue - 1));
+}
+
+/*typical measurement time in microseconds: 1 + 2 * osrs_t + (2 * osrs_p + 0.5) ms*/
+constexpr uint32_t measurement_time_typical_us(bmp280_over_sampling_t temperatureOS, bmp280_over_sampling_t pressureOS)
+{
+	return 1000 + 2000 * oversampling_factor(temperatureOS) + ((pressureOS == BMP280_OVERSAMPLING_0X) ? 0 : (2000 * oversampling_factor(pressureOS) + 500));
+}
+
+/*maximum measurement time in microseconds: 1.25 + 2.3 * osrs_t + (2.3 * osrs_p + 0.575) ms*/
+constexpr uint32_t measurement_time_max_us(bmp280_over_sampling_t temperatureOS, bmp280_over_sampling_t pressureOS)
+{
+	return 1250 + 2300 * oversampling_factor(temperatureOS) + ((pressureOS == BMP280_OVERSAMPLING_0X) ? 0 : (2300 * oversampling_factor(pressureOS) + 575));
+}
+
+/*standby time of normal mode in microseconds*/
+constexpr uint32_t standby_time_us(bmp280_standby_time_t standbyTime)
+{
+	switch (standbyTime)
+	{
+	case BMP280_T_STANDBY_500US:
+		return 500;
+	case BMP280_T_STANDBY_62500US:
+		return 62500;
+	case BMP280_T_STANDBY_125MS:
+		return 125000;
+	case BMP280_T_STANDBY_250MS:
+		return 250000;
+	case BMP280_T_STANDBY_500MS:
+		return 500000;
+	case BMP280_T_STANDBY_1S:
+		return 1000000;
+	case BMP280_T_STANDBY_2S:
+		return 2000000;
+	default:
+		return 4000000;
+	}
+}
+
+/*normal mode sample period in microseconds: one typical measurement plus the standby time*/
+constexpr uint32_t sample_period_us(bmp280_over_sampling_t temperatureOS, bmp280_over_sampling_t pressureOS, bmp280_standby_time_t standbyTime)
+{
+	return measurement_time_typical_us(temperatureOS, pressureOS) + standby_time_us(standbyTime);
+}
+
+/*normal mode output data rate in millihertz*/
+constexpr uint32_t output_data_rate_mhz(bmp280_over_sampling_t temperatureOS, bmp280_over_sampling_t pressureOS, bmp280_standby_time_t standbyTime)
+{
+	return (uint32_t)(1000000000ULL / sample_period_us(temperatureOS, pressureOS, standbyTime));
+}
+
+namespace golden
+{
+
+/*calibration and readings of the compensation example in the datasheet*/
+constexpr bmp280_calibration_param_t datasheet_dig = {27504, 26435, -1000, 36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000};
+
+static_assert(compensate_t_fine(datasheet_dig, 519888) == 128422, "t_fine does not match the datasheet");
+static_assert(compensate_temperature_centi(datasheet_dig, 519888) == 2508, "temperature does not match the datasheet");
+static_assert(compensate_pressure(datasheet_dig, 415148, 128422) == 100654, "pressure does not match the 32 bit integer compensation");
+
+/*ultra low power and ultra high resolution rows of the datasheet measurement time table*/
+static_assert(measurement_time_typical_us(BMP280_OVERSAMPLING_1X, BMP280_OVERSAMPLING_1X) == 5500, "");
+static_assert(measurement_time_max_us(BMP280_OVERSAMPLING_1X, BMP280_OVERSAMPLING_1X) == 6425, "");
+static_assert(measurement_time_typical_us(BMP280_OVERSAMPLING_2X, BMP280_OVERSAMPLING_16X) == 37500, "");
+static_assert(measurement_time_max_us(BMP280_OVERSAMPLING_2X, BMP280_OVERSAMPLING_16X) == 43225, "");
+
+/*ultra high resolution at 0.5 ms standby: 26.32 Hz in the datasheet output data rate table*/
+static_assert(output_data_rate_mhz(BMP280_OVERSAMPLING_2X, BMP280_OVERSAMPLING_16X, BMP280_T_STANDBY_500US) == 26315, "");
+
+}	/*namespace golden*/
+
+}	/*namespace bmp280*/
+
+#endif
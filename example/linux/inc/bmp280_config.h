@@ -5,7 +5,7 @@
 * @version 5.0
 * @Section HOW-TO-USE
 * This is the configuration file for BMP280 device driver. There are
-* 3 config constants and 3 macros.
+* 3 config constants and 8 macros.
 * If you want to use the altitude calculations, add:
 *	@code 
 *	#define BMP280_INCLUDE_ALTITUDE	1
@@ -18,6 +18,26 @@
 	@code
 	#define BMP280_INCLUDE_EXCLUSION_HOOK 1
 	@endcode
+* If you want to adopt an already running sensor from a calibration cache (warm start):
+	@code
+	#define BMP280_INCLUDE_WARM_START 1
+	@endcode
+* If you want normal mode reads aligned to the sensor's conversions (read scheduler):
+	@code
+	#define BMP280_INCLUDE_SCHEDULER 1
+	@endcode
+* If several devices share one bus object (transport, lock and statistics):
+	@code
+	#define BMP280_INCLUDE_SHARED_BUS 1
+	@endcode
+* If reads should run on an asynchronous transport (e.g. DMA) with completion callbacks; needs the getters:
+	@code
+	#define BMP280_INCLUDE_ASYNC 1
+	@endcode
+* If you want a watchdog of stuck data, lost settings and implausible samples (health monitor):
+	@code
+	#define BMP280_INCLUDE_HEALTH_MONITOR 1
+	@endcode
 
 * @license MIT 
 *
@@ -57,12 +77,19 @@ extern "C" {
 /*macros*/
 #define BMP280_INCLUDE_ALTITUDE	1
 #define BMP280_INCLUDE_ADDITIONAL_GETTERS 1
+#ifndef BMP280_INCLUDE_EXCLUSION_HOOK		/*can also be set by the build*/
 #define BMP280_INCLUDE_EXCLUSION_HOOK 0
+#endif
+#define BMP280_INCLUDE_WARM_START 1
+#define BMP280_INCLUDE_SCHEDULER 1
+#define BMP280_INCLUDE_SHARED_BUS 1
+#define BMP280_INCLUDE_ASYNC 1
+#define BMP280_INCLUDE_HEALTH_MONITOR 1
 
 /*config constants*/
 static const uint16_t BMP280_STARTUP_DELAY_IN_MS = 2000;
-static const uint8_t BMP280_MEASURING_POLL_TIMEOUT_IN_MS = 100; 		/*MAX: 255*/
-static const uint8_t BMP280_MEASURING_POLL_PERIOD_IN_MS = 1; 			/*must not be 0 and must be less than BMP280_MEASURING_POLL_TIMEOUT_IN_MS*/
+static const uint32_t BMP280_MEASURING_POLL_TIMEOUT_IN_US = 100000; 		/*exact with the clock dependency, otherwise rounded up to poll periods*/
+static const uint8_t BMP280_MEASURING_POLL_PERIOD_IN_MS = 1; 			/*must not be 0*/
 
 #ifdef __cplusplus
 }
@@ -1,12 +1,70 @@
 #include "interface.h"
+#include <errno.h>
+#include <linux/i2c.h>
 
-int BMP280_file_descriptor;
+/*a failed transfer is tried again up to this many times, after 0.5, 1, 2 and 4 ms*/
+#define I2C_RETRY_LIMIT 4
+#define I2C_RETRY_BACKOFF_US 500
+
+int BMP280_file_descriptor = -1;
 const char* bus_address;
+const char *default_i2c_bus_address = "/dev/i2c-1";
+
+bmp280_i2c_recovery_t bmp280_i2c_recovery;
+
+/*one mutex for the whole bus, shared by every sensor handle*/
+pthread_mutex_t bmp280_bus_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/*bus selected by the application, e.g. after discovery. overrides I2C_DEV_PATH*/
+static const char *selected_bus_address;
+
+/*several sensors can share the bus: it is opened once and the slave address is switched on demand*/
+static int bus_users;
+static int bus_slave_address = -1;
+
+/*points the bus to a slave address, only if it is not the current one*/
+static int bmp280_i2c_select(uint8_t deviceAddress)
+{
+	if(bus_slave_address == deviceAddress)
+	{
+		return 0;
+	}
+
+	if(ioctl(BMP280_file_descriptor, I2C_SLAVE, deviceAddress) < 0)
+	{
+		int error = errno;
+
+		perror("ERROR IN ACQUIRING BUS ACCESS");
+		bus_slave_address = -1;
+		errno = error;
+		return 1;
+	}
+
+	bus_slave_address = deviceAddress;
+
+	return 0;
+}
+
+/*selects the bus device used by the next bmp280_i2c_init(). the string must outlive the bus*/
+void bmp280_i2c_set_bus_path(const char *path)
+{
+	selected_bus_address = path;
+}
 
 /*initiates the I2C peripheral and sets its speed*/
 int bmp280_i2c_init(uint8_t deviceAddress)
 {
-	bus_address = getenv("I2C_DEV_PATH");
+	if(bus_users > 0)
+	{
+		bus_users++;
+		return 0;
+	}
+
+	bus_address = selected_bus_address;
+	if(bus_address == NULL)
+	{
+		bus_address = getenv("I2C_DEV_PATH");
+	}
 	if(bus_address == NULL)
 	{
 		bus_address = default_i2c_bus_address;
@@ -19,62 +77,140 @@ int bmp280_i2c_init(uint8_t deviceAddress)
 		return 1;
 	}
 
-	if(ioctl(BMP280_file_descriptor, I2C_SLAVE, deviceAddress) < 0)
+	bus_slave_address = -1;
+	if(bmp280_i2c_select(deviceAddress) != 0)
 	{
-		perror("ERROR IN ACQUIRING BUS ACCESS");
 		close(BMP280_file_descriptor);
+		BMP280_file_descriptor = -1;
 		return 2;
 	}
 
+	bus_users = 1;
+
 	return 0;
 }
 
-/*initiates the I2C peripheral and sets its speed*/
+/*closes the I2C bus once its last user is gone*/
 int bmp280_i2c_deinit(uint8_t deviceAddress)
 {
+	if(bus_users > 1)
+	{
+		bus_users--;
+		return 0;
+	}
+
 	close(BMP280_file_descriptor);
+	BMP280_file_descriptor = -1;
+	bus_slave_address = -1;
+	bus_users = 0;
 
 	return 0;
 }
 
 
-/*writes an array (data[]) of arbitrary size (dataLength) to I2C address (deviceAddress), starting from an internal register address (startRegisterAddress)*/
-int bmp280_write_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
+/*a transient error (lost arbitration, no acknowledge, timeout) is retried as it is, any other one after reopening the adapter*/
+static int bmp280_i2c_transient(int error)
 {
-	uint8_t buffer[dataLength + 1];
-	buffer[0] = startRegisterAddress;
-	memcpy(&buffer[1], data, dataLength);
+	return (error == EAGAIN || error == EREMOTEIO || error == ETIMEDOUT);
+}
 
-	if(write(BMP280_file_descriptor, buffer, dataLength + 1) != dataLength + 1)
+/*closes and reopens the adapter; the next transfer sets the slave address again*/
+static int bmp280_i2c_reopen(void)
+{
+	if(BMP280_file_descriptor >= 0)
 	{
-		perror("ERROR IN I2C WRITE");
 		close(BMP280_file_descriptor);
-		return 1;
+	}
+
+	bus_slave_address = -1;
+	BMP280_file_descriptor = (bus_address != NULL) ? open(bus_address, O_RDWR) : -1;
+
+	return (BMP280_file_descriptor < 0) ? 1 : 0;
+}
+
+/*one attempt of a write, followed by a read if readLength is not 0. returns 0 or the errno of the failing step*/
+static int bmp280_i2c_attempt(uint8_t deviceAddress, const uint8_t *buffer, uint8_t writeLength, uint8_t *data, uint8_t readLength)
+{
+	ssize_t length;
+
+	if(BMP280_file_descriptor < 0 && bmp280_i2c_reopen() != 0)
+	{
+		return ENODEV;
+	}
+
+	if(bmp280_i2c_select(deviceAddress) != 0)
+	{
+		return errno;
+	}
+
+	length = write(BMP280_file_descriptor, buffer, writeLength);
+	if(length != writeLength)
+	{
+		return (length < 0) ? errno : EIO;
+	}
+
+	if(readLength > 0)
+	{
+		length = read(BMP280_file_descriptor, data, readLength);
+		if(length != readLength)
+		{
+			return (length < 0) ? errno : EIO;
+		}
 	}
 
 	return 0;
 }
 
-/*reads an array (data[]) of arbitrary size (dataLength) from I2C address (deviceAddress), starting from an internal register address (startRegisterAddress)*/
-int bmp280_read_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
+/*retries a failed transfer after a pause that doubles each time, up to I2C_RETRY_LIMIT times*/
+static int bmp280_i2c_transfer(uint8_t deviceAddress, const uint8_t *buffer, uint8_t writeLength, uint8_t *data, uint8_t readLength)
 {
-	if(write(BMP280_file_descriptor, (void *)&startRegisterAddress, 1) != 1)
+	uint32_t backoff_us = I2C_RETRY_BACKOFF_US;
+	int error = bmp280_i2c_attempt(deviceAddress, buffer, writeLength, data, readLength);
+
+	for(int retry = 0; error != 0 && retry < I2C_RETRY_LIMIT; retry++)
 	{
-		perror("ERROR IN I2C WRITE");
-		close(BMP280_file_descriptor);
-		return 1;
+		if(bmp280_i2c_transient(error))
+		{
+			bmp280_i2c_recovery.retries++;
+		}
+		else
+		{
+			bmp280_i2c_recovery.reopens++;
+			bmp280_i2c_reopen();
+		}
+
+		delay_us_function(backoff_us);
+		backoff_us *= 2;
+
+		error = bmp280_i2c_attempt(deviceAddress, buffer, writeLength, data, readLength);
 	}
 
-	if(read(BMP280_file_descriptor, (void *)data, dataLength) != dataLength)
+	if(error != 0)
 	{
-		perror("ERROR IN I2C READ");
-		close(BMP280_file_descriptor);
-		return 2;
+		bmp280_i2c_recovery.failures++;
+		fprintf(stderr, "ERROR IN I2C TRANSFER: %s\n", strerror(error));
+		return 1;
 	}
 
 	return 0;
 }
 
+/*writes an array (data[]) of arbitrary size (dataLength) to I2C address (deviceAddress), starting from an internal register address (startRegisterAddress)*/
+int bmp280_write_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
+{
+	uint8_t buffer[dataLength + 1];
+	buffer[0] = startRegisterAddress;
+	memcpy(&buffer[1], data, dataLength);
+
+	return bmp280_i2c_transfer(deviceAddress, buffer, dataLength + 1, NULL, 0);
+}
+
+/*reads an array (data[]) of arbitrary size (dataLength) from I2C address (deviceAddress), starting from an internal register address (startRegisterAddress)*/
+int bmp280_read_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
+{
+	return bmp280_i2c_transfer(deviceAddress, &startRegisterAddress, 1, data, dataLength);
+}
+
 /*a delay function for milliseconds delay*/
 int delay_function(uint32_t delayMS)
 {
@@ -86,6 +222,24 @@ int delay_function(uint32_t delayMS)
 	return 0;
 }
 
+/*a delay function for microseconds delay*/
+int delay_us_function(uint32_t delayUS)
+{
+	struct timespec duration = {delayUS / 1000000, (long)(delayUS % 1000000) * 1000};
+
+	return (clock_nanosleep(CLOCK_MONOTONIC, 0, &duration, NULL) != 0) ? 1 : 0;
+}
+
+/*monotonic microsecond clock; the driver only uses differences, so the wrap around is harmless*/
+uint32_t clock_us(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint32_t)((uint64_t)now.tv_sec * 1000000 + (uint64_t)now.tv_nsec / 1000);
+}
+
 /*implements a power function (used in altitude calculation)*/
 int power_function(float x, float y, float *result)
 {
@@ -93,3 +247,100 @@ int power_function(float x, float y, float *result)
 
 	return 0;
 }
+
+/*mutual exclusion hooks, used with bmp280_bus_mutex*/
+int bmp280_mutex_lock(void *mutex_handle)
+{
+	return pthread_mutex_lock((pthread_mutex_t *)mutex_handle);
+}
+
+int bmp280_mutex_unlock(void *mutex_handle)
+{
+	return pthread_mutex_unlock((pthread_mutex_t *)mutex_handle);
+}
+
+#if BMP280_INCLUDE_SHARED_BUS
+/*every transfer carries its device address (I2C_RDWR), so switching between sensors costs no I2C_SLAVE call*/
+int bmp280_i2c_bus_open(bmp280_bus_t *bus, const char *path)
+{
+	int fd = open(path, O_RDWR);
+
+	if(fd < 0)
+	{
+		perror("ERROR OPENING I2C BUS");
+		return 1;
+	}
+
+	bus->context = (void *)(intptr_t)fd;
+	bus->bmp280_bus_read = bmp280_i2c_bus_read;
+	bus->bmp280_bus_write = bmp280_i2c_bus_write;
+	bus->current_address = 0;
+
+	return 0;
+}
+
+int bmp280_i2c_bus_close(bmp280_bus_t *bus)
+{
+	int fd = (int)(intptr_t)bus->context;
+
+	bus->context = (void *)(intptr_t)-1;
+
+	return (close(fd) == 0) ? 0 : 1;
+}
+
+/*the adapter of a bus belongs to its owner, so only transient errors are retried, with the same pauses*/
+static int bmp280_i2c_bus_transfer(int fd, struct i2c_rdwr_ioctl_data *transfer)
+{
+	uint32_t backoff_us = I2C_RETRY_BACKOFF_US;
+
+	for(int retry = 0; ioctl(fd, I2C_RDWR, transfer) != (int)transfer->nmsgs; retry++)
+	{
+		if(retry == I2C_RETRY_LIMIT || !bmp280_i2c_transient(errno))
+		{
+			bmp280_i2c_recovery.failures++;
+			return 1;
+		}
+
+		bmp280_i2c_recovery.retries++;
+		delay_us_function(backoff_us);
+		backoff_us *= 2;
+	}
+
+	return 0;
+}
+
+/*register address and data in one combined transaction (repeated start, no stop in between)*/
+int bmp280_i2c_bus_read(void *context, uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
+{
+	struct i2c_msg messages[2] = {
+		{deviceAddress, 0, 1, &startRegisterAddress},
+		{deviceAddress, I2C_M_RD, dataLength, data}};
+	struct i2c_rdwr_ioctl_data transfer = {messages, 2};
+
+	if(bmp280_i2c_bus_transfer((int)(intptr_t)context, &transfer) != 0)
+	{
+		perror("ERROR IN I2C READ");
+		return 1;
+	}
+
+	return 0;
+}
+
+int bmp280_i2c_bus_write(void *context, uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
+{
+	uint8_t buffer[dataLength + 1];
+	struct i2c_msg message = {deviceAddress, 0, (uint16_t)(dataLength + 1), buffer};
+	struct i2c_rdwr_ioctl_data transfer = {&message, 1};
+
+	buffer[0] = startRegisterAddress;
+	memcpy(&buffer[1], data, dataLength);
+
+	if(bmp280_i2c_bus_transfer((int)(intptr_t)context, &transfer) != 0)
+	{
+		perror("ERROR IN I2C WRITE");
+		return 1;
+	}
+
+	return 0;
+}
+#endif
@@ -10,15 +10,44 @@
 #include <linux/i2c-dev.h>
 #include <sys/ioctl.h>
 #include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include "bmp280.h"
 
 /*Default bus address in case of no env variable. Works with RPi.*/
-static const char *default_i2c_bus_address = "/dev/i2c-1";
+extern const char *default_i2c_bus_address;
 
+/*recovery events of the I2C transfers. the shared bus transport does not reopen its adapter, so it only retries*/
+typedef struct
+{
+	unsigned long retries;		/*transfers tried again after a transient error*/
+	unsigned long reopens;		/*adapter closed, reopened and addressed again after any other error*/
+	unsigned long failures;		/*transfers given up after the last retry*/
+	unsigned long reinits;		/*sensors brought back with bmp280_reinit(), counted by the application*/
+} bmp280_i2c_recovery_t;
+
+extern bmp280_i2c_recovery_t bmp280_i2c_recovery;
+
+void bmp280_i2c_set_bus_path(const char *path);
 int bmp280_i2c_init(uint8_t deviceAddress);
 int bmp280_i2c_deinit(uint8_t deviceAddress);
 int bmp280_read_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength);
 int bmp280_write_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength);
 int delay_function(uint32_t delayMS);
+uint32_t clock_us(void);
+int delay_us_function(uint32_t delayUS);
 int power_function(float x, float y, float *result);
+int bmp280_mutex_lock(void *mutex_handle);
+int bmp280_mutex_unlock(void *mutex_handle);
+
+#if BMP280_INCLUDE_SHARED_BUS
+/*shared bus transport: one open adapter (the bus context) for all sensors attached to the bus*/
+int bmp280_i2c_bus_open(bmp280_bus_t *bus, const char *path);
+int bmp280_i2c_bus_close(bmp280_bus_t *bus);
+int bmp280_i2c_bus_read(void *context, uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength);
+int bmp280_i2c_bus_write(void *context, uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength);
+#endif
+
+extern pthread_mutex_t bmp280_bus_mutex;
 
 #endif
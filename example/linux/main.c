@@ -1,6 +1,9 @@
 #include <stdio.h>
 #include "bmp280.h"
 #include "interface.h"
+#include "capture.h"
+#include "calibration_cache.h"
+#include "discovery.h"
 
 #define CHECK_AND_RETURN_ERROR(error)               \
     do                                              \
@@ -14,6 +17,15 @@
 
 bmp280_handle_t BMP280;
 bmp280_sensors_data_t sensorsData;
+bmp280_device_descriptor_t discoveredSensor;
+
+/*capture records stay in memory until the end of each loop iteration*/
+static uint8_t capture_buffer[64 * 1024];
+
+static void stop_capture(void)
+{
+    bmp280_capture_stop();
+}
 
 int main(int arg, char *argv[])
 {
@@ -23,30 +35,135 @@ int main(int arg, char *argv[])
     BMP280.dependency_interface.bmp280_read_array = bmp280_read_array;
     BMP280.dependency_interface.bmp280_delay_function = delay_function;
     BMP280.dependency_interface.bmp280_power_function = power_function;
+    BMP280.dependency_interface.bmp280_clock_us = clock_us;
+    BMP280.dependency_interface.bmp280_delay_us_function = delay_us_function;
+    #if BMP280_INCLUDE_EXCLUSION_HOOK
+    BMP280.dependency_interface.bmp280_interface_exclusion.bmp280_interface_lock = bmp280_mutex_lock;
+    BMP280.dependency_interface.bmp280_interface_exclusion.bmp280_interface_unlock = bmp280_mutex_unlock;
+    BMP280.dependency_interface.bmp280_interface_exclusion.mutex_handle = &bmp280_bus_mutex;
+    #endif
 
-    bmp280_error_code_t error = bmp280_init(&BMP280, BMP280_I2C, BMP280_I2C_ADDRESS_1);
-    CHECK_AND_RETURN_ERROR(error);
+    /*replay a previous capture instead of talking to the bus*/
+    const char *replay_path = getenv("BMP280_REPLAY_PATH");
+    /*record all bus transactions into a pcap file (Wireshark: I2C Linux)*/
+    const char *capture_path = getenv("BMP280_CAPTURE_PATH");
+    const char *bus_path = getenv("I2C_DEV_PATH");
+    const char *address_text = getenv("BMP280_I2C_ADDRESS");
+    bmp280_i2c_address_t address = BMP280_I2C_ADDRESS_1;
+    unsigned int bus_number = 1;
 
-    error = bmp280_set_mode(&BMP280, BMP280_MODE_NORMAL);
-    CHECK_AND_RETURN_ERROR(error);
-    error = bmp280_set_temperature_oversampling(&BMP280, BMP280_OVERSAMPLING_4X);
-    CHECK_AND_RETURN_ERROR(error);
-    error = bmp280_set_pressure_oversampling(&BMP280, BMP280_OVERSAMPLING_16X);
-    CHECK_AND_RETURN_ERROR(error);
-    error = bmp280_set_standby_time(&BMP280, BMP280_T_STANDBY_250MS);
-    CHECK_AND_RETURN_ERROR(error);
-    error = bmp280_set_filter_coefficient(&BMP280, BMP280_FILTER_16X);
+    if (address_text != NULL)
+    {
+        address = (bmp280_i2c_address_t)strtol(address_text, NULL, 16);
+    }
+
+    if (bus_path != NULL)
+    {
+        sscanf(bus_path, "/dev/i2c-%u", &bus_number);
+    }
+    else if (replay_path == NULL && address_text == NULL)
+    {
+        /*neither bus nor address given: use the first BMP280 found on any bus*/
+        if (bmp280_discover(&discoveredSensor, 1) == 1)
+        {
+            bmp280_i2c_set_bus_path(discoveredSensor.bus_path);
+            address = discoveredSensor.i2c_address;
+            bus_number = discoveredSensor.bus_number;
+            printf("FOUND BMP280 AT 0x%02X ON %s\n", (int)address, discoveredSensor.bus_path);
+        }
+    }
+
+    if (replay_path != NULL)
+    {
+        if (bmp280_replay_open(replay_path) != 0)
+        {
+            return -1;
+        }
+
+        BMP280.dependency_interface.bmp280_interface_init = bmp280_replay_init;
+        BMP280.dependency_interface.bmp280_interface_deinit = bmp280_replay_deinit;
+        BMP280.dependency_interface.bmp280_write_array = bmp280_replay_write_array;
+        BMP280.dependency_interface.bmp280_read_array = bmp280_replay_read_array;
+        BMP280.dependency_interface.bmp280_delay_function = bmp280_replay_delay_function;
+        /*a replay does not wait, so real time says nothing about the sensor*/
+        BMP280.dependency_interface.bmp280_clock_us = NULL;
+        BMP280.dependency_interface.bmp280_delay_us_function = NULL;
+    }
+    else if (capture_path != NULL)
+    {
+        if (bmp280_capture_start(capture_path, (uint8_t)bus_number, capture_buffer, sizeof(capture_buffer), bmp280_read_array, bmp280_write_array) != 0)
+        {
+            return -1;
+        }
+        atexit(stop_capture);
+
+        BMP280.dependency_interface.bmp280_write_array = bmp280_capture_write_array;
+        BMP280.dependency_interface.bmp280_read_array = bmp280_capture_read_array;
+    }
+
+    /*with a calibration cache, a restart adopts the running sensor instead of resetting it*/
+    const char *cache_path = getenv("BMP280_CACHE_PATH");
+    bmp280_warm_start_cache_t cache;
+    bmp280_error_code_t error;
+
+    if (cache_path != NULL)
+    {
+        bmp280_cache_load(cache_path, &cache);
+        error = bmp280_init_warm(&BMP280, BMP280_I2C, address, &cache);
+    }
+    else
+    {
+        error = bmp280_init(&BMP280, BMP280_I2C, address);
+    }
     CHECK_AND_RETURN_ERROR(error);
 
+    /*a warm started sensor is already running with this configuration*/
+    if (BMP280.operation_mode != BMP280_MODE_NORMAL)
+    {
+        error = bmp280_set_mode(&BMP280, BMP280_MODE_NORMAL);
+        CHECK_AND_RETURN_ERROR(error);
+        error = bmp280_set_temperature_oversampling(&BMP280, BMP280_OVERSAMPLING_4X);
+        CHECK_AND_RETURN_ERROR(error);
+        error = bmp280_set_pressure_oversampling(&BMP280, BMP280_OVERSAMPLING_16X);
+        CHECK_AND_RETURN_ERROR(error);
+        error = bmp280_set_standby_time(&BMP280, BMP280_T_STANDBY_250MS);
+        CHECK_AND_RETURN_ERROR(error);
+        error = bmp280_set_filter_coefficient(&BMP280, BMP280_FILTER_16X);
+        CHECK_AND_RETURN_ERROR(error);
+
+        if (cache_path != NULL)
+        {
+            error = bmp280_save_warm_start_cache(&BMP280, &cache);
+            CHECK_AND_RETURN_ERROR(error);
+            bmp280_cache_save(cache_path, &cache);
+        }
+    }
+
     for (;;)
     {
         error = bmp280_get_all(&BMP280, &sensorsData);
+        if ((error == BMP280_ERROR_INTERFACE_READ || error == BMP280_ERROR_INTERFACE_WRITE) && replay_path == NULL)
+        {
+            /*the transport already retried and reopened the bus: bring the sensor back and skip this sample. other errors are not the bus's*/
+            printf("ERROR CODE: %d, REINITIALIZING\n", (int)error);
+            error = bmp280_reinit(&BMP280);
+            bmp280_i2c_recovery.reinits++;
+            printf("REINIT: %d, RETRIES %lu, REOPENS %lu, FAILURES %lu, REINITS %lu\n", (int)error,
+                bmp280_i2c_recovery.retries, bmp280_i2c_recovery.reopens, bmp280_i2c_recovery.failures, bmp280_i2c_recovery.reinits);
+            sleep(1);
+            continue;
+        }
         CHECK_AND_RETURN_ERROR(error);
         error = bmp280_calculate_altitude_quick(&BMP280, &sensorsData.altitude, sensorsData.pressure);
         CHECK_AND_RETURN_ERROR(error);
 
         printf("TEMP: %.2f °C, PRESSURE: %d Pa, ALTITUDE: %.1f m\n", sensorsData.temperature, sensorsData.pressure, sensorsData.altitude);
 
+        if (capture_path != NULL && replay_path == NULL)
+        {
+            bmp280_capture_flush();
+        }
+
         sleep(1);
     }
 
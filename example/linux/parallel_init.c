@@ -0,0 +1,75 @@
+#include "parallel_init.h"
+#include <pthread.h>
+#include <stdio.h>
+
+#if BMP280_INCLUDE_SHARED_BUS
+
+#define BMP280_PARALLEL_INIT_MAX_GROUPS 32
+
+static void *bmp280_init_group_thread(void *argument)
+{
+	bmp280_init_group_t *group = (bmp280_init_group_t *)argument;
+
+	for(uint8_t index = 0; index < group->count; index++)
+	{
+		group->handles[index]->bus = group->bus;
+	}
+
+	group->error = bmp280_init_multiple(group->handles, group->hw_interface, group->i2c_addresses, group->count, group->errors);
+
+	return NULL;
+}
+
+/*buses are independent, so their groups overlap completely: total time is about one startup delay plus the slowest bus.
+a transport shared between groups, like the single adapter of bmp280_i2c_init(), would not be, so every group needs its own bus object*/
+int bmp280_parallel_init(bmp280_init_group_t *groups, uint8_t group_count)
+{
+	pthread_t threads[BMP280_PARALLEL_INIT_MAX_GROUPS];
+	uint8_t started = 0;
+	int result = 0;
+
+	if(group_count > BMP280_PARALLEL_INIT_MAX_GROUPS)
+	{
+		return 1;
+	}
+
+	for(uint8_t index = 0; index < group_count; index++)
+	{
+		if(groups[index].bus == NULL)
+		{
+			return 1;
+		}
+
+		for(uint8_t other = 0; other < index; other++)
+		{
+			if(groups[other].bus == groups[index].bus)
+			{
+				return 1;
+			}
+		}
+	}
+
+	for(; started < group_count; started++)
+	{
+		if(pthread_create(&threads[started], NULL, bmp280_init_group_thread, &groups[started]) != 0)
+		{
+			perror("ERROR STARTING INIT THREAD");
+			result = 2;
+			break;
+		}
+	}
+
+	for(uint8_t index = 0; index < started; index++)
+	{
+		pthread_join(threads[index], NULL);
+
+		if(groups[index].error != BMP280_ERROR_OK)
+		{
+			result = 3;
+		}
+	}
+
+	return result;
+}
+
+#endif
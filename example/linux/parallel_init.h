@@ -0,0 +1,29 @@
+#ifndef __PARALLEL_INIT_H__
+#define __PARALLEL_INIT_H__
+
+#include <stdint.h>
+#include "bmp280.h"
+
+#if BMP280_INCLUDE_SHARED_BUS
+
+/*the sensors of one bus. the bus object has its own transport context, e.g. an adapter opened with bmp280_i2c_bus_open(),
+and is attached to every handle of the group*/
+typedef struct
+{
+	bmp280_bus_t *bus;
+	bmp280_handle_t **handles;
+	const bmp280_i2c_address_t *i2c_addresses;
+	uint8_t count;
+	bmp280_hardware_interface_t hw_interface;
+	bmp280_error_code_t *errors;		/*result of each sensor, count entries*/
+	bmp280_error_code_t error;		/*result of bmp280_init_multiple() for this group*/
+} bmp280_init_group_t;
+
+/*runs bmp280_init_multiple() for every group on its own thread. returns 0 if all sensors are initialized,
+1 if a group has no bus object or shares it with another group, 2 if a thread could not be started,
+3 if some sensors failed (see the errors of their group)*/
+int bmp280_parallel_init(bmp280_init_group_t *groups, uint8_t group_count);
+
+#endif
+
+#endif
@@ -0,0 +1,493 @@
+/*
+ * bmp280_acquire: acquisition loop for many BMP280s on one thread, with epoll and one timerfd per sensor.
+ * Usage: bmp280_acquire.out [sensors] [seconds] [rate in Hz]		(default: 128 simulated sensors, 5 seconds, 20 Hz)
+ * Every sensor runs in forced mode on its own schedule, the sample times of the sensors spread over the period. The
+ * timerfd of a sensor expires at its sample time, where the loop starts bmp280_get_all_async(), and at the end of the
+ * conversion, where the timer of the driver completes. Transfers are done in place, so the thread only ever waits in
+ * epoll_wait(). With BMP280_DISCOVER set, every BMP280 found on the I2C adapters is read instead of simulated sensors;
+ * the transfers then block for their time on the bus. The sensors of each bus are initialized on their own thread.
+ * Prints the time the initialization took, the samples, the missed sample times, how late the sample times were served and the CPU time of the loop.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/resource.h>
+#include "bmp280.h"
+#include "interface.h"
+#include "discovery.h"
+#include "parallel_init.h"
+
+#if !BMP280_INCLUDE_ASYNC || !BMP280_INCLUDE_SHARED_BUS
+#error "bmp280_acquire needs BMP280_INCLUDE_ASYNC and BMP280_INCLUDE_SHARED_BUS"
+#endif
+
+#define MAX_SENSORS 250
+#define MAX_EVENTS 64
+
+/*calibration and readings of the compensation example in the datasheet*/
+static const uint8_t datasheet_calibration[24] = {
+    0x70, 0x6B, 0x43, 0x67, 0x18, 0xFC, 0x7D, 0x8E, 0x43, 0xD6, 0xD0, 0x0B,
+    0x27, 0x0B, 0x8C, 0x00, 0xF9, 0xFF, 0x8C, 0x3C, 0xF8, 0xC6, 0x70, 0x17};
+static const uint8_t datasheet_data[6] = {0x65, 0x5A, 0xC0, 0x7E, 0xED, 0x00};
+
+typedef struct
+{
+    bmp280_handle_t handle;
+    bmp280_async_operation_t operation;
+    bmp280_sensors_data_t data;
+    int timer_fd;
+    bmp280_async_complete_fp timer_complete;    /*timer of the driver in progress; NULL: the next expiry is a sample time*/
+    void *timer_context;
+    uint64_t sample_ns;                         /*next sample time*/
+    unsigned long samples;
+    unsigned long missed;
+    unsigned long failures;
+    uint64_t late_total_ns;
+    uint64_t late_max_ns;
+} sensor_t;
+
+static sensor_t sensors[MAX_SENSORS];
+static bmp280_bus_t buses[MAX_SENSORS];
+static unsigned int bus_count;
+
+/*the sensor the driver is working on: the driver is only called from the loop, one sensor at a time*/
+static sensor_t *current;
+
+static uint64_t period_ns;
+static unsigned int in_flight;
+static int running = 1;
+
+/*the simulation: registers of each sensor, at device address index + 1, and the end of its conversion*/
+static uint8_t registers[MAX_SENSORS][256];
+static uint64_t conversion_end_ns[MAX_SENSORS];
+static uint64_t conversion_ns;
+
+static uint64_t now_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+static int sim_transfer(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength, int write)
+{
+    unsigned int sensor = (unsigned int)deviceAddress - 1;
+    uint8_t *reg;
+
+    if (deviceAddress == 0 || sensor >= MAX_SENSORS)
+    {
+        return -1;
+    }
+    reg = registers[sensor];
+
+    if (!write)
+    {
+        reg[0xF3] = (now_ns() < conversion_end_ns[sensor]) ? 0x08 : 0x00;
+        memcpy(data, &reg[startRegisterAddress], dataLength);
+        return 0;
+    }
+
+    for (uint8_t index = 0; index < dataLength; index++)
+    {
+        uint8_t address = (uint8_t)(startRegisterAddress + index);
+
+        if (address == 0xE0 && data[index] == 0xB6)
+        {
+            reg[0xF4] = 0;
+            reg[0xF5] = 0;
+        }
+        else if (address == 0xF4 && (data[index] & 0x03) == 0x01)
+        {
+            /*forced: measuring for the typical conversion time, then back in sleep mode*/
+            reg[0xF4] = data[index] & 0xFC;
+            conversion_end_ns[sensor] = now_ns() + conversion_ns;
+        }
+        else
+        {
+            reg[address] = data[index];
+        }
+    }
+
+    return 0;
+}
+
+static int sim_bus_read(void *context, uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
+{
+    (void)context;
+
+    return sim_transfer(deviceAddress, startRegisterAddress, data, dataLength, 0);
+}
+
+static int sim_bus_write(void *context, uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
+{
+    (void)context;
+
+    return sim_transfer(deviceAddress, startRegisterAddress, data, dataLength, 1);
+}
+
+/*the simulated sensors need no time to start*/
+static int sim_delay(uint32_t delayMS)
+{
+    (void)delayMS;
+
+    return 0;
+}
+
+static void sim_reset(unsigned int sensor)
+{
+    uint8_t *reg = registers[sensor];
+
+    memset(reg, 0, 256);
+    reg[0xD0] = 0x58;
+    memcpy(&reg[0x88], datasheet_calibration, sizeof(datasheet_calibration));
+    memcpy(&reg[0xF7], datasheet_data, sizeof(datasheet_data));
+}
+
+/*a relative timerfd of 0 would disarm it*/
+static int arm_timer(int fd, uint64_t ns, int absolute)
+{
+    struct itimerspec timer = {{0, 0}, {(time_t)(ns / 1000000000ULL), (long)(ns % 1000000000ULL)}};
+
+    if (ns == 0)
+    {
+        timer.it_value.tv_nsec = 1;
+    }
+
+    return timerfd_settime(fd, absolute ? TFD_TIMER_ABSTIME : 0, &timer, NULL);
+}
+
+/*the asynchronous transport: transfers complete before the submit returns, timers on the timerfd of the sensor*/
+static int async_read(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength, bmp280_async_complete_fp complete, void *context)
+{
+    bmp280_bus_t *bus = current->handle.bus;
+
+    complete(context, bus->bmp280_bus_read(bus->context, deviceAddress, startRegisterAddress, data, dataLength));
+
+    return 0;
+}
+
+static int async_write(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength, bmp280_async_complete_fp complete, void *context)
+{
+    bmp280_bus_t *bus = current->handle.bus;
+
+    complete(context, bus->bmp280_bus_write(bus->context, deviceAddress, startRegisterAddress, data, dataLength));
+
+    return 0;
+}
+
+static int async_timer(uint32_t delayUS, bmp280_async_complete_fp complete, void *context)
+{
+    current->timer_complete = complete;
+    current->timer_context = context;
+
+    return (arm_timer(current->timer_fd, 1000ULL * delayUS, 0) == 0) ? 0 : -1;
+}
+
+/*the next sample time that is still ahead; the ones that passed meanwhile are missed*/
+static void schedule_next(sensor_t *sensor)
+{
+    uint64_t now = now_ns();
+
+    sensor->sample_ns += period_ns;
+    if (sensor->sample_ns <= now)
+    {
+        uint64_t behind = (now - sensor->sample_ns) / period_ns + 1;
+
+        sensor->missed += (unsigned long)behind;
+        sensor->sample_ns += behind * period_ns;
+    }
+
+    if (running)
+    {
+        arm_timer(sensor->timer_fd, sensor->sample_ns, 1);
+    }
+}
+
+static void sample_done(void *context, bmp280_error_code_t error)
+{
+    sensor_t *sensor = (sensor_t *)context;
+
+    in_flight--;
+
+    if (error != BMP280_ERROR_OK)
+    {
+        sensor->failures++;
+    }
+    else
+    {
+        sensor->samples++;
+    }
+
+    schedule_next(sensor);
+}
+
+static void start_sample(sensor_t *sensor)
+{
+    uint64_t late_ns = now_ns() - sensor->sample_ns;
+
+    sensor->late_total_ns += late_ns;
+    if (late_ns > sensor->late_max_ns)
+    {
+        sensor->late_max_ns = late_ns;
+    }
+
+    in_flight++;
+    if (bmp280_get_all_async(&sensor->handle, &sensor->operation, &sensor->data, sample_done, sensor) != BMP280_ERROR_OK)
+    {
+        in_flight--;
+        sensor->failures++;
+        schedule_next(sensor);
+    }
+}
+
+/*an expiry of the timerfd: the end of a timer of the driver, or a sample time*/
+static void timer_expired(sensor_t *sensor)
+{
+    uint64_t expirations;
+
+    if (read(sensor->timer_fd, &expirations, sizeof(expirations)) != (ssize_t)sizeof(expirations))
+    {
+        return;
+    }
+
+    current = sensor;
+
+    if (sensor->timer_complete != NULL)
+    {
+        bmp280_async_complete_fp complete = sensor->timer_complete;
+
+        sensor->timer_complete = NULL;
+        complete(sensor->timer_context, 0);
+    }
+    else if (running)
+    {
+        start_sample(sensor);
+    }
+}
+
+/*every BMP280 on the I2C adapters, each adapter opened once as a bus*/
+static unsigned int attach_discovered(bmp280_i2c_address_t addresses[])
+{
+    static bmp280_device_descriptor_t found[MAX_SENSORS];
+    int count = bmp280_discover(found, MAX_SENSORS);
+
+    for (int index = 0; index < count; index++)
+    {
+        if (bus_count == 0 || strcmp(found[index].bus_path, found[index - 1].bus_path) != 0)
+        {
+            if (bmp280_i2c_bus_open(&buses[bus_count], found[index].bus_path) != 0)
+            {
+                return 0;
+            }
+            bus_count++;
+        }
+
+        sensors[index].handle.bus = &buses[bus_count - 1];
+        sensors[index].handle.dependency_interface.bmp280_delay_function = delay_function;
+        addresses[index] = found[index].i2c_address;
+    }
+
+    return (count > 0) ? (unsigned int)count : 0;
+}
+
+static unsigned int attach_simulated(bmp280_i2c_address_t addresses[], unsigned int count)
+{
+    buses[0].bmp280_bus_read = sim_bus_read;
+    buses[0].bmp280_bus_write = sim_bus_write;
+    bus_count = 1;
+
+    for (unsigned int index = 0; index < count; index++)
+    {
+        sim_reset(index);
+        sensors[index].handle.bus = &buses[0];
+        sensors[index].handle.dependency_interface.bmp280_delay_function = sim_delay;
+        addresses[index] = (bmp280_i2c_address_t)(index + 1);
+    }
+
+    return count;
+}
+
+static double cpu_seconds(void)
+{
+    struct rusage usage;
+
+    getrusage(RUSAGE_SELF, &usage);
+
+    return (double)usage.ru_utime.tv_sec + (double)usage.ru_utime.tv_usec / 1e6 +
+           (double)usage.ru_stime.tv_sec + (double)usage.ru_stime.tv_usec / 1e6;
+}
+
+int main(int argc, char *argv[])
+{
+    bmp280_handle_t *handles[MAX_SENSORS];
+    bmp280_i2c_address_t addresses[MAX_SENSORS];
+    bmp280_error_code_t init_errors[MAX_SENSORS] = {BMP280_ERROR_OK};
+    bmp280_init_group_t groups[MAX_SENSORS];
+    unsigned int group_count = 0;
+    struct epoll_event events[MAX_EVENTS];
+    unsigned int count = (argc > 1) ? (unsigned int)atoi(argv[1]) : 128;
+    double seconds = (argc > 2) ? atof(argv[2]) : 5.0;
+    double rate_hz = (argc > 3) ? atof(argv[3]) : 20.0;
+    unsigned long samples = 0, missed = 0, failures = 0;
+    uint64_t late_total_ns = 0, late_max_ns = 0, start_ns, end_ns;
+    bmp280_timing_t timing;
+    double cpu_start, elapsed;
+    int epoll_fd;
+
+    if (count == 0 || count > MAX_SENSORS || seconds <= 0 || rate_hz <= 0)
+    {
+        fprintf(stderr, "USAGE: %s [sensors 1..%d] [seconds] [rate in Hz]\n", argv[0], MAX_SENSORS);
+        return 1;
+    }
+
+    count = (getenv("BMP280_DISCOVER") != NULL) ? attach_discovered(addresses) : attach_simulated(addresses, count);
+    if (count == 0)
+    {
+        fprintf(stderr, "NO SENSORS\n");
+        return 1;
+    }
+
+    for (unsigned int index = 0; index < count; index++)
+    {
+        bmp280_dependency_t *dependency = &sensors[index].handle.dependency_interface;
+
+        dependency->bmp280_power_function = power_function;
+        dependency->bmp280_clock_us = clock_us;
+        dependency->bmp280_async_read = async_read;
+        dependency->bmp280_async_write = async_write;
+        dependency->bmp280_async_timer = async_timer;
+        handles[index] = &sensors[index].handle;
+    }
+
+    /*the sensors of a bus share one reset delay, and the buses run in parallel. attach_discovered() keeps a bus together*/
+    for (unsigned int index = 0; index < count; index++)
+    {
+        if (group_count == 0 || sensors[index].handle.bus != groups[group_count - 1].bus)
+        {
+            groups[group_count].bus = sensors[index].handle.bus;
+            groups[group_count].handles = &handles[index];
+            groups[group_count].i2c_addresses = &addresses[index];
+            groups[group_count].count = 0;
+            groups[group_count].hw_interface = BMP280_I2C;
+            groups[group_count].errors = &init_errors[index];
+            group_count++;
+        }
+        groups[group_count - 1].count++;
+    }
+
+    start_ns = now_ns();
+    if (bmp280_parallel_init(groups, (uint8_t)group_count) != 0)
+    {
+        for (unsigned int index = 0; index < count; index++)
+        {
+            if (init_errors[index] != BMP280_ERROR_OK)
+            {
+                fprintf(stderr, "SENSOR 0x%02X ON BUS %u: INIT ERROR CODE %d\n", (int)addresses[index], (unsigned int)(sensors[index].handle.bus - buses), (int)init_errors[index]);
+            }
+        }
+        fprintf(stderr, "INIT FAILED\n");
+        return 1;
+    }
+    printf("INIT: %.1f MS FOR %u BUSES\n", (double)(now_ns() - start_ns) / 1e6, group_count);
+
+    for (unsigned int index = 0; index < count; index++)
+    {
+        if (bmp280_set_mode(handles[index], BMP280_MODE_FORCED) != BMP280_ERROR_OK)
+        {
+            fprintf(stderr, "SET MODE FAILED\n");
+            return 1;
+        }
+    }
+
+    bmp280_get_timing(handles[0], &timing);
+    conversion_ns = 1000ULL * timing.measurement_time_typical_us;
+    period_ns = (uint64_t)(1e9 / rate_hz);
+    if (period_ns < 1000ULL * timing.sample_period_us)
+    {
+        fprintf(stderr, "A FORCED CONVERSION TAKES UP TO %u US: AT MOST %.1f HZ\n", (unsigned int)timing.sample_period_us, timing.odr_hz);
+        return 1;
+    }
+
+    epoll_fd = epoll_create1(0);
+    if (epoll_fd < 0)
+    {
+        perror("EPOLL");
+        return 1;
+    }
+
+    start_ns = now_ns() + period_ns;
+    for (unsigned int index = 0; index < count; index++)
+    {
+        sensor_t *sensor = &sensors[index];
+        struct epoll_event event = {EPOLLIN, {.ptr = sensor}};
+
+        sensor->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+        if (sensor->timer_fd < 0 || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sensor->timer_fd, &event) != 0)
+        {
+            perror("TIMERFD");
+            return 1;
+        }
+
+        sensor->sample_ns = start_ns + period_ns * index / count;
+        arm_timer(sensor->timer_fd, sensor->sample_ns, 1);
+    }
+
+    cpu_start = cpu_seconds();
+    end_ns = start_ns + (uint64_t)(seconds * 1e9);
+
+    /*after the end, no new samples start; the ones in flight finish*/
+    while (running || in_flight > 0)
+    {
+        int ready = epoll_wait(epoll_fd, events, MAX_EVENTS, 100);
+
+        for (int index = 0; index < ready; index++)
+        {
+            timer_expired((sensor_t *)events[index].data.ptr);
+        }
+
+        if (running && now_ns() >= end_ns)
+        {
+            running = 0;
+        }
+    }
+
+    elapsed = (double)(now_ns() - start_ns) / 1e9;
+
+    for (unsigned int index = 0; index < count; index++)
+    {
+        samples += sensors[index].samples;
+        missed += sensors[index].missed;
+        failures += sensors[index].failures;
+        late_total_ns += sensors[index].late_total_ns;
+        if (sensors[index].late_max_ns > late_max_ns)
+        {
+            late_max_ns = sensors[index].late_max_ns;
+        }
+        close(sensors[index].timer_fd);
+    }
+    close(epoll_fd);
+
+    printf("%u SENSORS ON %u BUSES, FORCED MODE AT %.1f HZ, %.1f S\n", count, bus_count, rate_hz, seconds);
+    printf("SAMPLES: %lu (%.1f/S), MISSED SAMPLE TIMES: %lu, FAILURES: %lu\n", samples, (double)samples / elapsed, missed, failures);
+    printf("SAMPLE TIMES SERVED LATE BY: %.1f US AVERAGE, %.1f US MAX\n",
+        (samples + failures > 0) ? (double)late_total_ns / 1e3 / (double)(samples + failures) : 0.0, (double)late_max_ns / 1e3);
+    printf("CPU: %.1f%% OF ONE CORE\n", 100.0 * (cpu_seconds() - cpu_start) / elapsed);
+    printf("LAST SAMPLE OF SENSOR 0: %.2f C, %u PA\n", sensors[0].data.temperature, (unsigned int)sensors[0].data.pressure);
+
+    for (unsigned int index = 0; index < bus_count; index++)
+    {
+        if (buses[index].bmp280_bus_read != sim_bus_read)
+        {
+            bmp280_i2c_bus_close(&buses[index]);
+        }
+    }
+
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,471 @@
+/*
+ * bmp280_async_demo: several simulated BMP280s in forced mode, read through a threaded mock of an asynchronous (DMA) transport.
+ * Usage: bmp280_async_demo.out [sensors] [seconds]		(default: 8 sensors, 2 seconds)
+ * One worker thread plays the bus and the timers: transfers take the time of a 400 kHz bus, one after the other, and every
+ * completion is called from the worker. The main thread only starts the operations and is free otherwise. The same
+ * sensors are then read one after the other with the blocking bmp280_get_all() for comparison.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include "bmp280.h"
+
+#if !BMP280_INCLUDE_ASYNC
+#error "bmp280_async_demo needs BMP280_INCLUDE_ASYNC"
+#endif
+
+#define MAX_SENSORS 64
+#define FIRST_ADDRESS 0x10
+#define MAX_PENDING (2 * MAX_SENSORS)
+
+/*400 kHz: 9 bits per byte, plus the address byte*/
+#define BUS_NS_PER_BYTE 22500ULL
+
+/*a conversion of the default settings ends between the typical and the maximum measurement time*/
+#define CONVERSION_NS 6000000ULL
+
+/*calibration and readings of the compensation example in the datasheet*/
+static const uint8_t datasheet_calibration[24] = {
+    0x70, 0x6B, 0x43, 0x67, 0x18, 0xFC, 0x7D, 0x8E, 0x43, 0xD6, 0xD0, 0x0B,
+    0x27, 0x0B, 0x8C, 0x00, 0xF9, 0xFF, 0x8C, 0x3C, 0xF8, 0xC6, 0x70, 0x17};
+static const uint8_t datasheet_data[6] = {0x65, 0x5A, 0xC0, 0x7E, 0xED, 0x00};
+
+typedef enum
+{
+    PENDING_READ,
+    PENDING_WRITE,
+    PENDING_TIMER
+} pending_type_t;
+
+/*a submitted transfer or timer, completed by the worker at its due time*/
+typedef struct
+{
+    pending_type_t type;
+    uint8_t address;
+    uint8_t reg;
+    uint8_t *data;
+    uint8_t length;
+    bmp280_async_complete_fp complete;
+    void *context;
+    uint64_t due_ns;
+} pending_t;
+
+static uint8_t registers[MAX_SENSORS][256];
+static uint64_t conversion_end_ns[MAX_SENSORS];
+static bmp280_handle_t sensors[MAX_SENSORS];
+static bmp280_async_operation_t operations[MAX_SENSORS];
+static bmp280_sensors_data_t results[MAX_SENSORS];
+static unsigned long samples[MAX_SENSORS];
+static unsigned long failures;
+
+static pthread_mutex_t queue_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_changed = PTHREAD_COND_INITIALIZER;
+static pending_t pending[MAX_PENDING];
+static unsigned int pending_count;
+static uint64_t bus_free_ns;
+static int worker_running = 1;
+
+static volatile int streaming = 0;
+
+static uint64_t now_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+static uint8_t *sensor_registers(uint8_t deviceAddress)
+{
+    if (deviceAddress < FIRST_ADDRESS || deviceAddress >= FIRST_ADDRESS + MAX_SENSORS)
+    {
+        return NULL;
+    }
+
+    return registers[deviceAddress - FIRST_ADDRESS];
+}
+
+/*the register side of the simulation, shared by the blocking and the asynchronous transport*/
+static int sim_transfer(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength, int write)
+{
+    uint8_t *reg = sensor_registers(deviceAddress);
+    unsigned int sensor = (unsigned int)(deviceAddress - FIRST_ADDRESS);
+
+    if (reg == NULL)
+    {
+        return -1;
+    }
+
+    if (!write)
+    {
+        reg[0xF3] = (now_ns() < conversion_end_ns[sensor]) ? 0x08 : 0x00;
+        memcpy(data, &reg[startRegisterAddress], dataLength);
+        return 0;
+    }
+
+    for (uint8_t index = 0; index < dataLength; index++)
+    {
+        uint8_t address = (uint8_t)(startRegisterAddress + index);
+
+        if (address == 0xE0 && data[index] == 0xB6)
+        {
+            reg[0xF4] = 0;
+            reg[0xF5] = 0;
+        }
+        else if (address == 0xF4 && (data[index] & 0x03) == 0x01)
+        {
+            /*forced: measuring until the conversion is over, then back in sleep mode*/
+            reg[0xF4] = data[index] & 0xFC;
+            conversion_end_ns[sensor] = now_ns() + CONVERSION_NS;
+        }
+        else
+        {
+            reg[address] = data[index];
+        }
+    }
+
+    return 0;
+}
+
+static int sim_init(uint8_t deviceAddress)
+{
+    uint8_t *reg = sensor_registers(deviceAddress);
+
+    if (reg == NULL)
+    {
+        return -1;
+    }
+
+    memset(reg, 0, 256);
+    reg[0xD0] = 0x58;
+    memcpy(&reg[0x88], datasheet_calibration, sizeof(datasheet_calibration));
+    memcpy(&reg[0xF7], datasheet_data, sizeof(datasheet_data));
+
+    return 0;
+}
+
+static int sim_deinit(uint8_t deviceAddress)
+{
+    (void)deviceAddress;
+
+    return 0;
+}
+
+static void sleep_ns(uint64_t ns)
+{
+    struct timespec duration = {(time_t)(ns / 1000000000ULL), (long)(ns % 1000000000ULL)};
+
+    clock_nanosleep(CLOCK_MONOTONIC, 0, &duration, NULL);
+}
+
+/*the blocking transport takes the same bus time*/
+static int sim_read_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
+{
+    if (streaming)
+    {
+        sleep_ns(BUS_NS_PER_BYTE * (3 + dataLength));
+    }
+
+    return sim_transfer(deviceAddress, startRegisterAddress, data, dataLength, 0);
+}
+
+static int sim_write_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
+{
+    if (streaming)
+    {
+        sleep_ns(BUS_NS_PER_BYTE * (2 + dataLength));
+    }
+
+    return sim_transfer(deviceAddress, startRegisterAddress, data, dataLength, 1);
+}
+
+static int sim_delay(uint32_t delayMS)
+{
+    sleep_ns(1000000ULL * delayMS);
+
+    return 0;
+}
+
+static int sim_delay_us(uint32_t delayUS)
+{
+    sleep_ns(1000ULL * delayUS);
+
+    return 0;
+}
+
+static uint32_t sim_clock_us(void)
+{
+    return (uint32_t)(now_ns() / 1000);
+}
+
+static int sim_power(float x, float y, float *result)
+{
+    *result = powf(x, y);
+
+    return 0;
+}
+
+static int submit(pending_type_t type, uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength, uint64_t delay_ns, bmp280_async_complete_fp complete, void *context)
+{
+    uint64_t now = now_ns();
+    pending_t *item;
+
+    pthread_mutex_lock(&queue_mutex);
+
+    if (pending_count == MAX_PENDING)
+    {
+        pthread_mutex_unlock(&queue_mutex);
+        return -1;
+    }
+
+    item = &pending[pending_count++];
+    item->type = type;
+    item->address = deviceAddress;
+    item->reg = startRegisterAddress;
+    item->data = data;
+    item->length = dataLength;
+    item->complete = complete;
+    item->context = context;
+
+    /*transfers queue up on the bus; timers run in parallel*/
+    if (type == PENDING_TIMER)
+    {
+        item->due_ns = now + delay_ns;
+    }
+    else
+    {
+        bus_free_ns = ((bus_free_ns > now) ? bus_free_ns : now) + delay_ns;
+        item->due_ns = bus_free_ns;
+    }
+
+    pthread_cond_signal(&queue_changed);
+    pthread_mutex_unlock(&queue_mutex);
+
+    return 0;
+}
+
+static int async_read(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength, bmp280_async_complete_fp complete, void *context)
+{
+    return submit(PENDING_READ, deviceAddress, startRegisterAddress, data, dataLength, BUS_NS_PER_BYTE * (3 + dataLength), complete, context);
+}
+
+static int async_write(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength, bmp280_async_complete_fp complete, void *context)
+{
+    return submit(PENDING_WRITE, deviceAddress, startRegisterAddress, data, dataLength, BUS_NS_PER_BYTE * (2 + dataLength), complete, context);
+}
+
+static int async_timer(uint32_t delayUS, bmp280_async_complete_fp complete, void *context)
+{
+    return submit(PENDING_TIMER, 0, 0, NULL, 0, 1000ULL * delayUS, complete, context);
+}
+
+/*completes the earliest due item; the completion runs without the queue lock, so it can submit the next step*/
+static void *worker_thread(void *argument)
+{
+    (void)argument;
+
+    pthread_mutex_lock(&queue_mutex);
+
+    while (worker_running)
+    {
+        unsigned int earliest = 0;
+        struct timespec due;
+        pending_t item;
+        int result = 0;
+
+        if (pending_count == 0)
+        {
+            pthread_cond_wait(&queue_changed, &queue_mutex);
+            continue;
+        }
+
+        for (unsigned int index = 1; index < pending_count; index++)
+        {
+            if (pending[index].due_ns < pending[earliest].due_ns)
+            {
+                earliest = index;
+            }
+        }
+
+        if (pending[earliest].due_ns > now_ns())
+        {
+            due.tv_sec = (time_t)(pending[earliest].due_ns / 1000000000ULL);
+            due.tv_nsec = (long)(pending[earliest].due_ns % 1000000000ULL);
+            pthread_cond_timedwait(&queue_changed, &queue_mutex, &due);
+            continue;
+        }
+
+        item = pending[earliest];
+        pending[earliest] = pending[--pending_count];
+        pthread_mutex_unlock(&queue_mutex);
+
+        if (item.type != PENDING_TIMER)
+        {
+            result = sim_transfer(item.address, item.reg, item.data, item.length, item.type == PENDING_WRITE);
+        }
+        item.complete(item.context, result);
+
+        pthread_mutex_lock(&queue_mutex);
+    }
+
+    pthread_mutex_unlock(&queue_mutex);
+
+    return NULL;
+}
+
+/*runs in the worker: counts the sample and starts the next one of the same sensor*/
+static void sample_done(void *context, bmp280_error_code_t error)
+{
+    unsigned long index = (unsigned long)context;
+
+    if (error != BMP280_ERROR_OK)
+    {
+        failures++;
+        return;
+    }
+
+    samples[index]++;
+
+    if (streaming)
+    {
+        if (bmp280_get_all_async(&sensors[index], &operations[index], &results[index], sample_done, context) != BMP280_ERROR_OK)
+        {
+            failures++;
+        }
+    }
+}
+
+static unsigned long total_samples(unsigned int count)
+{
+    unsigned long total = 0;
+
+    for (unsigned int index = 0; index < count; index++)
+    {
+        total += samples[index];
+    }
+
+    return total;
+}
+
+int main(int argc, char *argv[])
+{
+    bmp280_handle_t *handles[MAX_SENSORS];
+    bmp280_i2c_address_t addresses[MAX_SENSORS];
+    bmp280_error_code_t init_errors[MAX_SENSORS];
+    unsigned int count = (argc > 1) ? (unsigned int)atoi(argv[1]) : 8;
+    double seconds = (argc > 2) ? atof(argv[2]) : 2.0;
+    unsigned long free_loops = 0;
+    double blocking_rate, async_rate, start;
+    pthread_t worker;
+
+    if (count == 0 || count > MAX_SENSORS || seconds <= 0)
+    {
+        fprintf(stderr, "USAGE: %s [sensors 1..%d] [seconds]\n", argv[0], MAX_SENSORS);
+        return 1;
+    }
+
+    for (unsigned int index = 0; index < count; index++)
+    {
+        sensors[index].dependency_interface.bmp280_interface_init = sim_init;
+        sensors[index].dependency_interface.bmp280_interface_deinit = sim_deinit;
+        sensors[index].dependency_interface.bmp280_write_array = sim_write_array;
+        sensors[index].dependency_interface.bmp280_read_array = sim_read_array;
+        sensors[index].dependency_interface.bmp280_delay_function = sim_delay;
+        sensors[index].dependency_interface.bmp280_delay_us_function = sim_delay_us;
+        sensors[index].dependency_interface.bmp280_clock_us = sim_clock_us;
+        sensors[index].dependency_interface.bmp280_power_function = sim_power;
+        sensors[index].dependency_interface.bmp280_async_read = async_read;
+        sensors[index].dependency_interface.bmp280_async_write = async_write;
+        sensors[index].dependency_interface.bmp280_async_timer = async_timer;
+        handles[index] = &sensors[index];
+        addresses[index] = (bmp280_i2c_address_t)(FIRST_ADDRESS + index);
+    }
+
+    if (bmp280_init_multiple(handles, BMP280_I2C, addresses, (uint8_t)count, init_errors) != BMP280_ERROR_OK)
+    {
+        fprintf(stderr, "INIT FAILED\n");
+        return 1;
+    }
+
+    for (unsigned int index = 0; index < count; index++)
+    {
+        if (bmp280_set_mode(&sensors[index], BMP280_MODE_FORCED) != BMP280_ERROR_OK)
+        {
+            fprintf(stderr, "SET MODE FAILED\n");
+            return 1;
+        }
+    }
+
+    /*blocking: one sensor after the other on the calling thread*/
+    streaming = 1;
+    start = (double)now_ns() / 1e9;
+    while ((double)now_ns() / 1e9 - start < seconds)
+    {
+        for (unsigned int index = 0; index < count; index++)
+        {
+            if (bmp280_get_all(&sensors[index], &results[index]) != BMP280_ERROR_OK)
+            {
+                fprintf(stderr, "SENSOR %u FAILED\n", index);
+                return 1;
+            }
+            samples[index]++;
+        }
+    }
+    blocking_rate = (double)total_samples(count) / ((double)now_ns() / 1e9 - start);
+
+    /*asynchronous: every sensor has an operation in flight, the main thread only counts its free loops*/
+    memset(samples, 0, sizeof(samples));
+    pthread_create(&worker, NULL, worker_thread, NULL);
+
+    start = (double)now_ns() / 1e9;
+    for (unsigned long index = 0; index < count; index++)
+    {
+        if (bmp280_get_all_async(&sensors[index], &operations[index], &results[index], sample_done, (void *)index) != BMP280_ERROR_OK)
+        {
+            fprintf(stderr, "ASYNC START FAILED\n");
+            return 1;
+        }
+    }
+
+    while ((double)now_ns() / 1e9 - start < seconds)
+    {
+        free_loops++;
+    }
+    streaming = 0;
+    async_rate = (double)total_samples(count) / ((double)now_ns() / 1e9 - start);
+
+    /*let the operations in flight finish before the worker stops*/
+    for (;;)
+    {
+        unsigned int busy = 0;
+
+        for (unsigned int index = 0; index < count; index++)
+        {
+            busy += (operations[index].step != BMP280_ASYNC_IDLE);
+        }
+
+        if (busy == 0)
+        {
+            break;
+        }
+        sleep_ns(1000000ULL);
+    }
+
+    pthread_mutex_lock(&queue_mutex);
+    worker_running = 0;
+    pthread_cond_signal(&queue_changed);
+    pthread_mutex_unlock(&queue_mutex);
+    pthread_join(worker, NULL);
+
+    printf("%u SENSORS, FORCED MODE, %.1f S PER RUN\n", count, seconds);
+    printf("BLOCKING, ONE AFTER THE OTHER: %8.1f SAMPLES/S\n", blocking_rate);
+    printf("ASYNCHRONOUS, ALL IN FLIGHT:   %8.1f SAMPLES/S (%.2fx), %lu FAILURES\n", async_rate, async_rate / blocking_rate, failures);
+    printf("MAIN THREAD FREE LOOPS WHILE ASYNCHRONOUS: %lu\n", free_loops);
+    printf("LAST SAMPLE OF SENSOR 0: %.2f C, %u PA\n", results[0].temperature, (unsigned int)results[0].pressure);
+
+    return (failures == 0) ? 0 : 1;
+}
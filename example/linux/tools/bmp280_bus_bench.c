@@ -0,0 +1,296 @@
+/*
+ * bmp280_bus_bench: several simulated BMP280s on one simulated I2C bus, each read by its own thread in forced mode.
+ * Usage: bmp280_bus_bench.out [sensors] [seconds]		(default: 4 sensors, 2 seconds)
+ * Runs twice: once with the bus lock also held while the driver waits (how the driver used to behave), once as the
+ * driver is, and prints the samples per second of both. Needs BMP280_INCLUDE_EXCLUSION_HOOK (make bench sets it).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include "bmp280.h"
+
+#if !BMP280_INCLUDE_EXCLUSION_HOOK
+#error "bmp280_bus_bench needs BMP280_INCLUDE_EXCLUSION_HOOK"
+#endif
+
+#define MAX_SENSORS 16
+#define FIRST_ADDRESS 0x10
+
+/*400 kHz: 9 bits per byte, plus the address byte*/
+#define BUS_NS_PER_BYTE 22500L
+
+/*calibration and readings of the compensation example in the datasheet*/
+static const uint8_t datasheet_calibration[24] = {
+    0x70, 0x6B, 0x43, 0x67, 0x18, 0xFC, 0x7D, 0x8E, 0x43, 0xD6, 0xD0, 0x0B,
+    0x27, 0x0B, 0x8C, 0x00, 0xF9, 0xFF, 0x8C, 0x3C, 0xF8, 0xC6, 0x70, 0x17};
+static const uint8_t datasheet_data[6] = {0x65, 0x5A, 0xC0, 0x7E, 0xED, 0x00};
+
+static uint8_t registers[MAX_SENSORS][256];
+static pthread_mutex_t bus_mutex = PTHREAD_MUTEX_INITIALIZER;
+static bmp280_handle_t sensors[MAX_SENSORS];
+static unsigned long samples[MAX_SENSORS];
+
+static volatile int timing_enabled = 0;
+static volatile int hold_lock_in_delay = 0;
+static volatile int running = 0;
+
+static void sleep_ns(long ns)
+{
+    struct timespec duration = {ns / 1000000000L, ns % 1000000000L};
+
+    nanosleep(&duration, NULL);
+}
+
+static double now_seconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+static uint8_t *sensor_registers(uint8_t deviceAddress)
+{
+    if (deviceAddress < FIRST_ADDRESS || deviceAddress >= FIRST_ADDRESS + MAX_SENSORS)
+    {
+        return NULL;
+    }
+
+    return registers[deviceAddress - FIRST_ADDRESS];
+}
+
+static int sim_init(uint8_t deviceAddress)
+{
+    uint8_t *reg = sensor_registers(deviceAddress);
+
+    if (reg == NULL)
+    {
+        return -1;
+    }
+
+    memset(reg, 0, 256);
+    reg[0xD0] = 0x58;
+    memcpy(&reg[0x88], datasheet_calibration, sizeof(datasheet_calibration));
+    memcpy(&reg[0xF7], datasheet_data, sizeof(datasheet_data));
+
+    return 0;
+}
+
+static int sim_deinit(uint8_t deviceAddress)
+{
+    (void)deviceAddress;
+
+    return 0;
+}
+
+static int sim_read_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
+{
+    uint8_t *reg = sensor_registers(deviceAddress);
+
+    if (reg == NULL)
+    {
+        return -1;
+    }
+
+    /*register address write, repeated start, then the data*/
+    if (timing_enabled)
+    {
+        sleep_ns(BUS_NS_PER_BYTE * (3 + dataLength));
+    }
+
+    memcpy(data, &reg[startRegisterAddress], dataLength);
+
+    return 0;
+}
+
+static int sim_write_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
+{
+    uint8_t *reg = sensor_registers(deviceAddress);
+
+    if (reg == NULL)
+    {
+        return -1;
+    }
+
+    if (timing_enabled)
+    {
+        sleep_ns(BUS_NS_PER_BYTE * (2 + dataLength));
+    }
+
+    for (uint8_t index = 0; index < dataLength; index++)
+    {
+        uint8_t address = (uint8_t)(startRegisterAddress + index);
+
+        if (address == 0xE0 && data[index] == 0xB6)
+        {
+            reg[0xF4] = 0;
+            reg[0xF5] = 0;
+        }
+        else if (address == 0xF4 && (data[index] & 0x03) != 0x03)
+        {
+            /*a forced conversion is over by the time the driver looks at it; the sensor is back in sleep mode*/
+            reg[0xF4] = data[index] & 0xFC;
+        }
+        else
+        {
+            reg[address] = data[index];
+        }
+    }
+
+    return 0;
+}
+
+/*with hold_lock_in_delay, every wait keeps the bus to itself, as if the driver called it with the lock held*/
+static int sim_delay(uint32_t delayMS)
+{
+    if (!timing_enabled)
+    {
+        return 0;
+    }
+
+    if (hold_lock_in_delay)
+    {
+        pthread_mutex_lock(&bus_mutex);
+    }
+
+    sleep_ns(1000000L * (long)delayMS);
+
+    if (hold_lock_in_delay)
+    {
+        pthread_mutex_unlock(&bus_mutex);
+    }
+
+    return 0;
+}
+
+static int sim_power(float x, float y, float *result)
+{
+    *result = powf(x, y);
+
+    return 0;
+}
+
+static int bus_lock(void *mutex_handle)
+{
+    return pthread_mutex_lock((pthread_mutex_t *)mutex_handle);
+}
+
+static int bus_unlock(void *mutex_handle)
+{
+    return pthread_mutex_unlock((pthread_mutex_t *)mutex_handle);
+}
+
+static void set_dependencies(bmp280_handle_t *handle)
+{
+    handle->dependency_interface.bmp280_interface_init = sim_init;
+    handle->dependency_interface.bmp280_interface_deinit = sim_deinit;
+    handle->dependency_interface.bmp280_write_array = sim_write_array;
+    handle->dependency_interface.bmp280_read_array = sim_read_array;
+    handle->dependency_interface.bmp280_delay_function = sim_delay;
+    handle->dependency_interface.bmp280_power_function = sim_power;
+    handle->dependency_interface.bmp280_interface_exclusion.bmp280_interface_lock = bus_lock;
+    handle->dependency_interface.bmp280_interface_exclusion.bmp280_interface_unlock = bus_unlock;
+    handle->dependency_interface.bmp280_interface_exclusion.mutex_handle = &bus_mutex;
+}
+
+static void *sensor_thread(void *argument)
+{
+    unsigned long index = (unsigned long)argument;
+    bmp280_sensors_data_t data;
+
+    while (running)
+    {
+        if (bmp280_get_all(&sensors[index], &data) != BMP280_ERROR_OK)
+        {
+            fprintf(stderr, "SENSOR %lu FAILED\n", index);
+            break;
+        }
+        samples[index]++;
+    }
+
+    return NULL;
+}
+
+/*returns the total samples per second of all sensors*/
+static double run(unsigned int count, double seconds)
+{
+    pthread_t threads[MAX_SENSORS];
+    unsigned long total = 0;
+    double start;
+
+    memset(samples, 0, sizeof(samples));
+    timing_enabled = 1;
+    running = 1;
+
+    start = now_seconds();
+    for (unsigned long index = 0; index < count; index++)
+    {
+        pthread_create(&threads[index], NULL, sensor_thread, (void *)index);
+    }
+
+    sleep_ns((long)(seconds * 1e9));
+    running = 0;
+
+    for (unsigned int index = 0; index < count; index++)
+    {
+        pthread_join(threads[index], NULL);
+        total += samples[index];
+    }
+
+    timing_enabled = 0;
+
+    return (double)total / (now_seconds() - start);
+}
+
+int main(int argc, char *argv[])
+{
+    bmp280_handle_t *handles[MAX_SENSORS];
+    bmp280_i2c_address_t addresses[MAX_SENSORS];
+    bmp280_error_code_t init_errors[MAX_SENSORS];
+    unsigned int count = (argc > 1) ? (unsigned int)atoi(argv[1]) : 4;
+    double seconds = (argc > 2) ? atof(argv[2]) : 2.0;
+    double held, released;
+
+    if (count == 0 || count > MAX_SENSORS || seconds <= 0)
+    {
+        fprintf(stderr, "USAGE: %s [sensors 1..%d] [seconds]\n", argv[0], MAX_SENSORS);
+        return 1;
+    }
+
+    for (unsigned int index = 0; index < count; index++)
+    {
+        set_dependencies(&sensors[index]);
+        handles[index] = &sensors[index];
+        addresses[index] = (bmp280_i2c_address_t)(FIRST_ADDRESS + index);
+    }
+
+    if (bmp280_init_multiple(handles, BMP280_I2C, addresses, (uint8_t)count, init_errors) != BMP280_ERROR_OK)
+    {
+        fprintf(stderr, "INIT FAILED\n");
+        return 1;
+    }
+
+    for (unsigned int index = 0; index < count; index++)
+    {
+        if (bmp280_set_mode(&sensors[index], BMP280_MODE_FORCED) != BMP280_ERROR_OK)
+        {
+            fprintf(stderr, "SET MODE FAILED\n");
+            return 1;
+        }
+    }
+
+    hold_lock_in_delay = 1;
+    held = run(count, seconds);
+    hold_lock_in_delay = 0;
+    released = run(count, seconds);
+
+    printf("%u SENSORS, FORCED MODE, %.1f S PER RUN\n", count, seconds);
+    printf("LOCK HELD WHILE WAITING:     %8.1f SAMPLES/S\n", held);
+    printf("LOCK ONLY FOR BUS TRAFFIC:   %8.1f SAMPLES/S (%.2fx)\n", released, released / held);
+
+    return 0;
+}
@@ -0,0 +1,215 @@
+/*
+ * bmp280_compensation_check: compares the constexpr compensation of bmp280_compensation.hpp with the C driver.
+ * Usage: bmp280_compensation_check.out [step]		(default: 1021, the step through both 20 bit ADC ranges)
+ * A simulated sensor holds each raw temperature and pressure of the grid in its data registers, read back with
+ * bmp280_get_temperature() and bmp280_get_pressure(). The same raw values go through bmp280::compensate_t_fine(),
+ * bmp280::temperature_from_t_fine() and bmp280::compensate_pressure(). This runs for the datasheet calibration and
+ * for calibrations spread around it. Any difference is printed, and the exit status is 1.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include "bmp280.h"
+#include "bmp280_compensation.hpp"
+
+#define CALIBRATIONS 8
+#define MAX_REPORTS 10
+
+/*calibration of the compensation example in the datasheet*/
+static const bmp280_calibration_param_t datasheet_dig = {27504, 26435, -1000, 36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000};
+
+static uint8_t registers[256];
+
+static int sim_init(uint8_t deviceAddress)
+{
+    (void)deviceAddress;
+
+    registers[0xD0] = 0x58;
+
+    return 0;
+}
+
+static int sim_deinit(uint8_t deviceAddress)
+{
+    (void)deviceAddress;
+
+    return 0;
+}
+
+static int sim_read_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
+{
+    (void)deviceAddress;
+
+    memcpy(data, &registers[startRegisterAddress], dataLength);
+
+    return 0;
+}
+
+/*the reset and the settings only need to read back; the data registers keep what the grid put there*/
+static int sim_write_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
+{
+    (void)deviceAddress;
+
+    for (uint8_t index = 0; index < dataLength; index++)
+    {
+        uint8_t address = (uint8_t)(startRegisterAddress + index);
+
+        if (address != 0xE0)
+        {
+            registers[address] = data[index];
+        }
+    }
+
+    return 0;
+}
+
+static int sim_delay(uint32_t delayMS)
+{
+    (void)delayMS;
+
+    return 0;
+}
+
+static int sim_power(float x, float y, float *result)
+{
+    *result = powf(x, y);
+
+    return 0;
+}
+
+/*the calibration registers hold T1..P9 as little endian 16 bit words*/
+static void store_calibration(const bmp280_calibration_param_t &dig)
+{
+    const uint16_t words[12] = {dig.T1, (uint16_t)dig.T2, (uint16_t)dig.T3, dig.P1, (uint16_t)dig.P2, (uint16_t)dig.P3,
+                                (uint16_t)dig.P4, (uint16_t)dig.P5, (uint16_t)dig.P6, (uint16_t)dig.P7, (uint16_t)dig.P8, (uint16_t)dig.P9};
+
+    for (unsigned int index = 0; index < 12; index++)
+    {
+        registers[0x88 + 2 * index] = (uint8_t)(words[index] & 0xFF);
+        registers[0x89 + 2 * index] = (uint8_t)(words[index] >> 8);
+    }
+}
+
+static void store_raw(uint8_t *reg, int32_t raw)
+{
+    reg[0] = (uint8_t)(raw >> 12);
+    reg[1] = (uint8_t)(raw >> 4);
+    reg[2] = (uint8_t)((raw & 0x0F) << 4);
+}
+
+/*a deterministic spread of up to a fifth of each coefficient around the datasheet calibration*/
+static int16_t spread(int16_t value, uint32_t *seed)
+{
+    int32_t range = std::abs((int32_t)value) / 5 + 1;
+
+    *seed = *seed * 1103515245U + 12345U;
+
+    return (int16_t)(value + (int32_t)((*seed >> 8) % (uint32_t)(2 * range + 1)) - range);
+}
+
+static bmp280_calibration_param_t calibration(unsigned int index)
+{
+    bmp280_calibration_param_t dig = datasheet_dig;
+    uint32_t seed = index;
+
+    if (index == 0)
+    {
+        return dig;
+    }
+
+    dig.T1 = (uint16_t)spread((int16_t)(dig.T1 / 2), &seed) * 2;
+    dig.T2 = spread(dig.T2, &seed);
+    dig.T3 = spread(dig.T3, &seed);
+    dig.P1 = (uint16_t)spread((int16_t)(dig.P1 / 2), &seed) * 2;
+    dig.P2 = spread(dig.P2, &seed);
+    dig.P3 = spread(dig.P3, &seed);
+    dig.P4 = spread(dig.P4, &seed);
+    dig.P5 = spread(dig.P5, &seed);
+    dig.P6 = spread(dig.P6, &seed);
+    dig.P7 = spread(dig.P7, &seed);
+    dig.P8 = spread(dig.P8, &seed);
+    dig.P9 = spread(dig.P9, &seed);
+
+    return dig;
+}
+
+int main(int argc, char **argv)
+{
+    int32_t step = (argc > 1) ? atoi(argv[1]) : 1021;
+    unsigned long points = 0, mismatches = 0;
+    bmp280_handle_t sensor;
+
+    if (step <= 0)
+    {
+        fprintf(stderr, "USAGE: %s [step]\n", argv[0]);
+        return 1;
+    }
+
+    memset(&sensor, 0, sizeof(sensor));
+    sensor.dependency_interface.bmp280_interface_init = sim_init;
+    sensor.dependency_interface.bmp280_interface_deinit = sim_deinit;
+    sensor.dependency_interface.bmp280_write_array = sim_write_array;
+    sensor.dependency_interface.bmp280_read_array = sim_read_array;
+    sensor.dependency_interface.bmp280_delay_function = sim_delay;
+    sensor.dependency_interface.bmp280_power_function = sim_power;
+
+    for (unsigned int index = 0; index < CALIBRATIONS; index++)
+    {
+        const bmp280_calibration_param_t dig = calibration(index);
+
+        store_calibration(dig);
+        if (bmp280_init(&sensor, BMP280_I2C, BMP280_I2C_ADDRESS_1) != BMP280_ERROR_OK)
+        {
+            fprintf(stderr, "INIT FAILED\n");
+            return 1;
+        }
+
+        for (int32_t adc_T = 0; adc_T < 0x100000; adc_T += step)
+        {
+            int32_t t_fine = bmp280::compensate_t_fine(dig, adc_T);
+            float temperature;
+
+            store_raw(&registers[0xFA], adc_T);
+            if (bmp280_get_temperature(&sensor, &temperature) != BMP280_ERROR_OK)
+            {
+                fprintf(stderr, "READ FAILED\n");
+                return 1;
+            }
+
+            if (temperature != bmp280::temperature_from_t_fine(t_fine))
+            {
+                if (mismatches++ < MAX_REPORTS)
+                {
+                    printf("calibration %u adc_T %ld: C %.2f constexpr %.2f\n", index, (long)adc_T, temperature, bmp280::temperature_from_t_fine(t_fine));
+                }
+            }
+
+            for (int32_t adc_P = 0; adc_P < 0x100000; adc_P += step)
+            {
+                uint32_t pressure;
+
+                store_raw(&registers[0xF7], adc_P);
+                if (bmp280_get_pressure(&sensor, &pressure) != BMP280_ERROR_OK)
+                {
+                    fprintf(stderr, "READ FAILED\n");
+                    return 1;
+                }
+
+                if (pressure != bmp280::compensate_pressure(dig, adc_P, t_fine))
+                {
+                    if (mismatches++ < MAX_REPORTS)
+                    {
+                        printf("calibration %u adc_T %ld adc_P %ld: C %lu constexpr %lu\n", index, (long)adc_T, (long)adc_P,
+                               (unsigned long)pressure, (unsigned long)bmp280::compensate_pressure(dig, adc_P, t_fine));
+                    }
+                }
+                points++;
+            }
+        }
+    }
+
+    printf("%lu points of %d calibrations, %lu mismatches\n", points, CALIBRATIONS, mismatches);
+
+    return (mismatches == 0) ? 0 : 1;
+}
@@ -0,0 +1,373 @@
+/*
+ * bmp280_rt: real-time acquisition runner. Reads one BMP280 at a fixed rate from a SCHED_FIFO thread pinned to one CPU,
+ * with all its memory locked, waking on absolute clock_nanosleep() deadlines.
+ * Usage: bmp280_rt.out [rate in Hz] [cpu] [benchmark samples]		(default: 100 Hz, CPU 0, runs until stopped)
+ * Every second it prints the histogram of the inter-sample jitter: how far the time between the starts of two reads is
+ * from the period. With benchmark samples, it takes that many samples and prints the p50/p99/p99.9 of the jitter and
+ * of the wake-up latency instead.
+ * The sensor is selected as in main.c (I2C_DEV_PATH, BMP280_I2C_ADDRESS) and runs in normal mode; BMP280_SIMULATE=1
+ * reads a simulated sensor. SCHED_FIFO and mlockall() need root (or CAP_SYS_NICE and CAP_IPC_LOCK); without them the
+ * runner still runs, and says so.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/mman.h>
+#include "bmp280.h"
+#include "interface.h"
+
+#define RT_PRIORITY 80
+#define PREFAULT_STACK_SIZE (256 * 1024)
+
+/*log2 buckets of microseconds: <1, <2, <4 ... <1024, and 1024 or more*/
+#define HISTOGRAM_BUCKETS 12
+
+/*calibration and readings of the compensation example in the datasheet*/
+static const uint8_t datasheet_calibration[24] = {
+    0x70, 0x6B, 0x43, 0x67, 0x18, 0xFC, 0x7D, 0x8E, 0x43, 0xD6, 0xD0, 0x0B,
+    0x27, 0x0B, 0x8C, 0x00, 0xF9, 0xFF, 0x8C, 0x3C, 0xF8, 0xC6, 0x70, 0x17};
+static const uint8_t datasheet_data[6] = {0x65, 0x5A, 0xC0, 0x7E, 0xED, 0x00};
+
+static bmp280_handle_t sensor;
+static uint8_t sim_registers[256];
+static unsigned long histogram[HISTOGRAM_BUCKETS];
+static volatile sig_atomic_t running = 1;
+
+static void stop_handler(int signal_number)
+{
+    (void)signal_number;
+
+    running = 0;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+static void sleep_until(uint64_t deadline_ns)
+{
+    struct timespec deadline = {(time_t)(deadline_ns / 1000000000ULL), (long)(deadline_ns % 1000000000ULL)};
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) != 0 && running)
+    {
+    }
+}
+
+static int sim_init(uint8_t deviceAddress)
+{
+    (void)deviceAddress;
+
+    memset(sim_registers, 0, sizeof(sim_registers));
+    sim_registers[0xD0] = 0x58;
+    memcpy(&sim_registers[0x88], datasheet_calibration, sizeof(datasheet_calibration));
+    memcpy(&sim_registers[0xF7], datasheet_data, sizeof(datasheet_data));
+
+    return 0;
+}
+
+static int sim_deinit(uint8_t deviceAddress)
+{
+    (void)deviceAddress;
+
+    return 0;
+}
+
+static int sim_read_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
+{
+    (void)deviceAddress;
+
+    memcpy(data, &sim_registers[startRegisterAddress], dataLength);
+
+    return 0;
+}
+
+static int sim_write_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
+{
+    (void)deviceAddress;
+
+    for (uint8_t index = 0; index < dataLength; index++)
+    {
+        uint8_t address = (uint8_t)(startRegisterAddress + index);
+
+        if (address == 0xE0 && data[index] == 0xB6)
+        {
+            sim_registers[0xF4] = 0;
+            sim_registers[0xF5] = 0;
+        }
+        else
+        {
+            sim_registers[address] = data[index];
+        }
+    }
+
+    return 0;
+}
+
+/*pin to the CPU, lock all memory present and future, and switch to SCHED_FIFO; returns how many of them worked*/
+static int enter_real_time(int cpu)
+{
+    struct sched_param parameter = {RT_PRIORITY};
+    volatile uint8_t stack[PREFAULT_STACK_SIZE];
+    cpu_set_t cpus;
+    int granted = 0;
+
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    if (sched_setaffinity(0, sizeof(cpus), &cpus) == 0)
+    {
+        granted++;
+    }
+    else
+    {
+        perror("WARNING: CPU AFFINITY");
+    }
+
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0)
+    {
+        granted++;
+    }
+    else
+    {
+        perror("WARNING: MLOCKALL");
+    }
+
+    /*fault the stack in now, not in the loop*/
+    for (size_t index = 0; index < sizeof(stack); index += 4096)
+    {
+        stack[index] = 0;
+    }
+
+    if (sched_setscheduler(0, SCHED_FIFO, &parameter) == 0)
+    {
+        granted++;
+    }
+    else
+    {
+        perror("WARNING: SCHED_FIFO");
+    }
+
+    return granted;
+}
+
+static unsigned int histogram_bucket(uint64_t jitter_ns)
+{
+    unsigned int bucket = 0;
+
+    for (uint64_t limit_us = 1; bucket < HISTOGRAM_BUCKETS - 1 && jitter_ns >= limit_us * 1000; limit_us <<= 1)
+    {
+        bucket++;
+    }
+
+    return bucket;
+}
+
+static void print_histogram(unsigned long samples, unsigned long overruns, uint64_t max_ns)
+{
+    printf("%lu SAMPLES, %lu OVERRUNS, MAX %.1f US, JITTER US:", samples, overruns, (double)max_ns / 1e3);
+    for (unsigned int bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++)
+    {
+        if (bucket < HISTOGRAM_BUCKETS - 1)
+        {
+            printf(" <%u:%lu", 1u << bucket, histogram[bucket]);
+        }
+        else
+        {
+            printf(" >=%u:%lu", 1u << (bucket - 1), histogram[bucket]);
+        }
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+static int compare_ns(const void *a, const void *b)
+{
+    uint64_t left = *(const uint64_t *)a;
+    uint64_t right = *(const uint64_t *)b;
+
+    return (left > right) - (left < right);
+}
+
+/*nearest rank*/
+static double percentile_us(const uint64_t *sorted, unsigned long count, double percent)
+{
+    unsigned long rank = (unsigned long)(percent / 100.0 * (double)count + 0.999999);
+
+    return (double)sorted[(rank > 0) ? rank - 1 : 0] / 1e3;
+}
+
+static void print_percentiles(const char *name, uint64_t *values, unsigned long count)
+{
+    qsort(values, count, sizeof(values[0]), compare_ns);
+    printf("%-20s P50 %8.1f US   P99 %8.1f US   P99.9 %8.1f US   MAX %8.1f US\n", name,
+        percentile_us(values, count, 50.0), percentile_us(values, count, 99.0), percentile_us(values, count, 99.9),
+        (double)values[count - 1] / 1e3);
+}
+
+int main(int argc, char *argv[])
+{
+    double rate_hz = (argc > 1) ? atof(argv[1]) : 100.0;
+    int cpu = (argc > 2) ? atoi(argv[2]) : 0;
+    unsigned long bench_samples = (argc > 3) ? strtoul(argv[3], NULL, 10) : 0;
+    const char *address_text = getenv("BMP280_I2C_ADDRESS");
+    const char *bus_path = getenv("I2C_DEV_PATH");
+    bmp280_i2c_address_t address = BMP280_I2C_ADDRESS_1;
+    uint64_t *jitter_ns = NULL, *latency_ns = NULL;
+    uint64_t period_ns, deadline_ns, last_start_ns = 0, max_ns = 0, next_report_ns;
+    unsigned long samples = 0, overruns = 0, failures = 0;
+    struct sigaction action = {0};
+    bmp280_sensors_data_t data;
+    bmp280_error_code_t error;
+
+    if (rate_hz <= 0 || rate_hz > 10000 || cpu < 0)
+    {
+        fprintf(stderr, "USAGE: %s [rate in Hz] [cpu] [benchmark samples]\n", argv[0]);
+        return 1;
+    }
+    period_ns = (uint64_t)(1e9 / rate_hz);
+
+    if (getenv("BMP280_SIMULATE") != NULL)
+    {
+        sensor.dependency_interface.bmp280_interface_init = sim_init;
+        sensor.dependency_interface.bmp280_interface_deinit = sim_deinit;
+        sensor.dependency_interface.bmp280_write_array = sim_write_array;
+        sensor.dependency_interface.bmp280_read_array = sim_read_array;
+    }
+    else
+    {
+        sensor.dependency_interface.bmp280_interface_init = bmp280_i2c_init;
+        sensor.dependency_interface.bmp280_interface_deinit = bmp280_i2c_deinit;
+        sensor.dependency_interface.bmp280_write_array = bmp280_write_array;
+        sensor.dependency_interface.bmp280_read_array = bmp280_read_array;
+    }
+    sensor.dependency_interface.bmp280_delay_function = delay_function;
+    sensor.dependency_interface.bmp280_delay_us_function = delay_us_function;
+    sensor.dependency_interface.bmp280_clock_us = clock_us;
+    sensor.dependency_interface.bmp280_power_function = power_function;
+    #if BMP280_INCLUDE_EXCLUSION_HOOK
+    sensor.dependency_interface.bmp280_interface_exclusion.bmp280_interface_lock = bmp280_mutex_lock;
+    sensor.dependency_interface.bmp280_interface_exclusion.bmp280_interface_unlock = bmp280_mutex_unlock;
+    sensor.dependency_interface.bmp280_interface_exclusion.mutex_handle = &bmp280_bus_mutex;
+    #endif
+
+    if (address_text != NULL)
+    {
+        address = (bmp280_i2c_address_t)strtol(address_text, NULL, 16);
+    }
+    if (bus_path != NULL)
+    {
+        bmp280_i2c_set_bus_path(bus_path);
+    }
+
+    error = bmp280_init(&sensor, BMP280_I2C, address);
+    if (error == BMP280_ERROR_OK)
+    {
+        error = bmp280_set_profile(&sensor, BMP280_PROFILE_INDOOR_NAVIGATION);
+    }
+    if (error != BMP280_ERROR_OK)
+    {
+        printf("ERROR CODE: %d\n", (int)error);
+        return (int)error;
+    }
+
+    /*everything the loop touches exists, and is locked, before it starts*/
+    if (bench_samples > 0)
+    {
+        jitter_ns = calloc(bench_samples, sizeof(uint64_t));
+        latency_ns = calloc(bench_samples, sizeof(uint64_t));
+        if (jitter_ns == NULL || latency_ns == NULL)
+        {
+            fprintf(stderr, "OUT OF MEMORY\n");
+            return 1;
+        }
+    }
+
+    action.sa_handler = stop_handler;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    if (enter_real_time(cpu) < 3)
+    {
+        printf("NOT FULLY REAL-TIME: THE JITTER BELOW HAS NO BOUND\n");
+    }
+    printf("%.1f HZ ON CPU %d, SCHED_FIFO PRIORITY %d\n", rate_hz, cpu, RT_PRIORITY);
+    /*fault the buffers in, in case mlockall() was refused*/
+    if (bench_samples > 0)
+    {
+        memset(jitter_ns, 0, bench_samples * sizeof(uint64_t));
+        memset(latency_ns, 0, bench_samples * sizeof(uint64_t));
+    }
+
+    deadline_ns = now_ns() + period_ns;
+    next_report_ns = deadline_ns + 1000000000ULL;
+
+    while (running && (bench_samples == 0 || samples < bench_samples))
+    {
+        uint64_t start_ns;
+
+        sleep_until(deadline_ns);
+        start_ns = now_ns();
+
+        error = bmp280_get_all(&sensor, &data);
+        if (error != BMP280_ERROR_OK)
+        {
+            failures++;
+        }
+
+        /*the first sample has no interval*/
+        if (last_start_ns != 0)
+        {
+            uint64_t interval_ns = start_ns - last_start_ns;
+            uint64_t jitter = (interval_ns > period_ns) ? interval_ns - period_ns : period_ns - interval_ns;
+
+            histogram[histogram_bucket(jitter)]++;
+            if (jitter > max_ns)
+            {
+                max_ns = jitter;
+            }
+
+            if (bench_samples > 0)
+            {
+                jitter_ns[samples] = jitter;
+                latency_ns[samples] = start_ns - deadline_ns;
+            }
+            samples++;
+        }
+        last_start_ns = start_ns;
+
+        /*an overrun: the next deadline passed during the read, so the schedule starts over from now*/
+        deadline_ns += period_ns;
+        if (now_ns() >= deadline_ns)
+        {
+            overruns++;
+            deadline_ns = now_ns() + period_ns;
+        }
+
+        if (bench_samples == 0 && start_ns >= next_report_ns)
+        {
+            print_histogram(samples, overruns, max_ns);
+            next_report_ns += 1000000000ULL;
+        }
+    }
+
+    print_histogram(samples, overruns, max_ns);
+    printf("LAST SAMPLE: %.2f C, %u PA, %lu FAILURES\n", data.temperature, (unsigned int)data.pressure, failures);
+
+    if (bench_samples > 0 && samples > 0)
+    {
+        print_percentiles("INTER-SAMPLE JITTER", jitter_ns, samples);
+        print_percentiles("WAKE-UP LATENCY", latency_ns, samples);
+    }
+
+    bmp280_deinit(&sensor);
+
+    return (failures == 0) ? 0 : 1;
+}
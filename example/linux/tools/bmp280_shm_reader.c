@@ -0,0 +1,44 @@
+/*
+ * Prints the samples published by bmp280d. Reading a sample is lock free and makes no system call.
+ * Usage: bmp280_shm_reader		(BMP280_SHM_NAME selects the segment)
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "bmp280_shm.h"
+
+int main(int argc, char *argv[])
+{
+    const char *shm_name = getenv("BMP280_SHM_NAME");
+
+    (void)argc;
+    (void)argv;
+
+    if (shm_name == NULL)
+    {
+        shm_name = BMP280_SHM_DEFAULT_NAME;
+    }
+
+    const bmp280_shm_t *shm = bmp280_shm_open(shm_name);
+    if (shm == NULL)
+    {
+        return -1;
+    }
+
+    for (;;)
+    {
+        for (uint32_t index = 0; index < shm->sensor_count; index++)
+        {
+            bmp280_shm_sample_t sample;
+
+            if (bmp280_shm_read(shm, index, &sample) == 0)
+            {
+                printf("0x%02X #%u: TEMP: %.2f °C, PRESSURE: %u Pa, ERROR CODE: %d\n", sample.i2c_address, sample.sequence, sample.data.temperature, sample.data.pressure, (int)sample.error);
+            }
+        }
+
+        sleep(1);
+    }
+
+    return 0;
+}
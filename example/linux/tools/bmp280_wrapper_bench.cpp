@@ -0,0 +1,209 @@
+/*
+ * bmp280_wrapper_bench: the C driver and the C++ wrapper read the same simulated sensor, and the time per read is compared.
+ * Usage: bmp280_wrapper_bench.out [reads]		(default: 5000000 reads per run)
+ * The sensor is a register array in memory, so a read costs only the driver: the status poll, the data read and the
+ * compensation. The C driver reaches it through the function pointers of its dependency interface, the wrapper through
+ * a bus policy it can inline. The raw values change on every read. Each path runs 5 times; the best run is printed,
+ * with the size of the C handle and of the wrapper's device. make wrapper builds both with -O2.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <ctime>
+#include "bmp280.h"
+#include "bmp280.hpp"
+
+#define RUNS 5
+
+/*calibration and readings of the compensation example in the datasheet*/
+static const uint8_t datasheet_calibration[24] = {
+    0x70, 0x6B, 0x43, 0x67, 0x18, 0xFC, 0x7D, 0x8E, 0x43, 0xD6, 0xD0, 0x0B,
+    0x27, 0x0B, 0x8C, 0x00, 0xF9, 0xFF, 0x8C, 0x3C, 0xF8, 0xC6, 0x70, 0x17};
+static const uint8_t datasheet_data[6] = {0x65, 0x5A, 0xC0, 0x7E, 0xED, 0x00};
+
+static uint8_t registers[256];
+
+static volatile uint32_t sink;
+
+static double now_s(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+static int sim_init(uint8_t deviceAddress)
+{
+    (void)deviceAddress;
+
+    memset(registers, 0, sizeof(registers));
+    registers[0xD0] = 0x58;
+    memcpy(&registers[0x88], datasheet_calibration, sizeof(datasheet_calibration));
+    memcpy(&registers[0xF7], datasheet_data, sizeof(datasheet_data));
+
+    return 0;
+}
+
+static int sim_deinit(uint8_t deviceAddress)
+{
+    (void)deviceAddress;
+
+    return 0;
+}
+
+static int sim_read_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
+{
+    (void)deviceAddress;
+
+    memcpy(data, &registers[startRegisterAddress], dataLength);
+
+    return 0;
+}
+
+/*a reset clears the settings; the data registers keep their values*/
+static int sim_write_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
+{
+    (void)deviceAddress;
+
+    for (uint8_t index = 0; index < dataLength; index++)
+    {
+        uint8_t address = (uint8_t)(startRegisterAddress + index);
+
+        if (address == 0xE0 && data[index] == 0xB6)
+        {
+            registers[0xF4] = 0;
+            registers[0xF5] = 0;
+        }
+        else
+        {
+            registers[address] = data[index];
+        }
+    }
+
+    return 0;
+}
+
+static int sim_delay(uint32_t delayMS)
+{
+    (void)delayMS;
+
+    return 0;
+}
+
+static int sim_power(float x, float y, float *result)
+{
+    *result = powf(x, y);
+
+    return 0;
+}
+
+/*the same transport as a bus policy*/
+struct sim_bus
+{
+    int init(uint8_t deviceAddress) { return sim_init(deviceAddress); }
+    int deinit(uint8_t deviceAddress) { return sim_deinit(deviceAddress); }
+    int read_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength) { return sim_read_array(deviceAddress, startRegisterAddress, data, dataLength); }
+    int write_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength) { return sim_write_array(deviceAddress, startRegisterAddress, data, dataLength); }
+    int delay_ms(uint32_t delayMS) { return sim_delay(delayMS); }
+};
+
+/*a new raw temperature and pressure near the datasheet example, so no result can be reused*/
+static void next_sample(unsigned long index)
+{
+    registers[0xF9] = (uint8_t)(index << 4);
+    registers[0xFC] = (uint8_t)((index >> 4) << 4);
+}
+
+static double run_c(bmp280_handle_t *sensor, unsigned long reads)
+{
+    double start = now_s();
+
+    for (unsigned long index = 0; index < reads; index++)
+    {
+        float temperature;
+        uint32_t pressure;
+
+        next_sample(index);
+        if (bmp280_get_temperature(sensor, &temperature) != BMP280_ERROR_OK || bmp280_get_pressure(sensor, &pressure) != BMP280_ERROR_OK)
+        {
+            fprintf(stderr, "C READ FAILED\n");
+            exit(1);
+        }
+        sink = sink + pressure + (uint32_t)temperature;
+    }
+
+    return (now_s() - start) * 1e9 / (double)reads;
+}
+
+static double run_wrapper(bmp280::device<sim_bus> &sensor, unsigned long reads)
+{
+    double start = now_s();
+
+    for (unsigned long index = 0; index < reads; index++)
+    {
+        next_sample(index);
+        auto temperature = sensor.get_temperature();
+        auto pressure = sensor.get_pressure();
+        if (!temperature || !pressure)
+        {
+            fprintf(stderr, "WRAPPER READ FAILED\n");
+            exit(1);
+        }
+        sink = sink + pressure.value() + (uint32_t)temperature.value();
+    }
+
+    return (now_s() - start) * 1e9 / (double)reads;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long reads = (argc > 1) ? strtoul(argv[1], NULL, 10) : 5000000UL;
+    double c_ns = 0, wrapper_ns = 0;
+    bmp280_handle_t handle;
+
+    if (reads == 0)
+    {
+        fprintf(stderr, "USAGE: %s [reads]\n", argv[0]);
+        return 1;
+    }
+
+    memset(&handle, 0, sizeof(handle));
+    handle.dependency_interface.bmp280_interface_init = sim_init;
+    handle.dependency_interface.bmp280_interface_deinit = sim_deinit;
+    handle.dependency_interface.bmp280_write_array = sim_write_array;
+    handle.dependency_interface.bmp280_read_array = sim_read_array;
+    handle.dependency_interface.bmp280_delay_function = sim_delay;
+    handle.dependency_interface.bmp280_power_function = sim_power;
+
+    if (bmp280_init(&handle, BMP280_I2C, BMP280_I2C_ADDRESS_1) != BMP280_ERROR_OK || bmp280_set_mode(&handle, BMP280_MODE_NORMAL) != BMP280_ERROR_OK)
+    {
+        fprintf(stderr, "C INIT FAILED\n");
+        return 1;
+    }
+
+    auto opened = bmp280::device<sim_bus>::open(sim_bus{}, BMP280_I2C, BMP280_I2C_ADDRESS_1);
+    if (!opened || opened.value().set_mode(BMP280_MODE_NORMAL) != BMP280_ERROR_OK)
+    {
+        fprintf(stderr, "WRAPPER INIT FAILED\n");
+        return 1;
+    }
+    bmp280::device<sim_bus> &sensor = opened.value();
+
+    /*both read the same registers, one after the other*/
+    for (int run = 0; run < RUNS; run++)
+    {
+        double ns = run_c(&handle, reads);
+        c_ns = (run == 0 || ns < c_ns) ? ns : c_ns;
+
+        ns = run_wrapper(sensor, reads);
+        wrapper_ns = (run == 0 || ns < wrapper_ns) ? ns : wrapper_ns;
+    }
+
+    printf("temperature and pressure read: C %.1f ns, wrapper %.1f ns (%.2fx)\n", c_ns, wrapper_ns, c_ns / wrapper_ns);
+    printf("size: C handle %zu bytes, wrapper device %zu bytes\n", sizeof(bmp280_handle_t), sizeof(bmp280::device<sim_bus>));
+
+    return 0;
+}
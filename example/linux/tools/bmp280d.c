@@ -0,0 +1,186 @@
+/*
+ * bmp280d: owns the sensors on one I2C bus and publishes their latest samples into shared memory (see bmp280_shm.h).
+ * Usage: bmp280d [i2c address in hex]...		(default: 0x76)
+ * The bus is selected with I2C_DEV_PATH, the shared-memory name with BMP280_SHM_NAME.
+ * All sensors are attached to one bus object and read back to back under one lock hold per period.
+ */
+#include <stdio.h>
+#include <signal.h>
+#include <time.h>
+#include "bmp280.h"
+#include "interface.h"
+#include "bmp280_shm.h"
+
+/*the sensors run in normal mode at about 10 Hz; the publisher follows at the same pace*/
+#define PUBLISH_PERIOD_NS 100000000L
+
+static bmp280_handle_t sensors[BMP280_SHM_MAX_SENSORS];
+static bmp280_bus_t bus;
+static volatile sig_atomic_t running = 1;
+
+static void stop_handler(int signal_number)
+{
+    (void)signal_number;
+
+    running = 0;
+}
+
+/*transport and lock come from the bus*/
+static void set_dependencies(bmp280_handle_t *handle)
+{
+    handle->dependency_interface.bmp280_delay_function = delay_function;
+    handle->dependency_interface.bmp280_power_function = power_function;
+    handle->dependency_interface.bmp280_clock_us = clock_us;
+    handle->dependency_interface.bmp280_delay_us_function = delay_us_function;
+    handle->bus = &bus;
+}
+
+static bmp280_error_code_t configure_sensor(bmp280_handle_t *handle)
+{
+    bmp280_error_code_t error = bmp280_set_temperature_oversampling(handle, BMP280_OVERSAMPLING_2X);
+    if (error != BMP280_ERROR_OK)
+    {
+        return error;
+    }
+    error = bmp280_set_pressure_oversampling(handle, BMP280_OVERSAMPLING_16X);
+    if (error != BMP280_ERROR_OK)
+    {
+        return error;
+    }
+    error = bmp280_set_standby_time(handle, BMP280_T_STANDBY_62500US);
+    if (error != BMP280_ERROR_OK)
+    {
+        return error;
+    }
+    error = bmp280_set_filter_coefficient(handle, BMP280_FILTER_4X);
+    if (error != BMP280_ERROR_OK)
+    {
+        return error;
+    }
+
+    return bmp280_set_mode(handle, BMP280_MODE_NORMAL);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t sensor_count = 0;
+    const char *shm_name = getenv("BMP280_SHM_NAME");
+    struct sigaction action = {0};
+    struct timespec next_wakeup;
+
+    if (shm_name == NULL)
+    {
+        shm_name = BMP280_SHM_DEFAULT_NAME;
+    }
+
+    bmp280_handle_t *handles[BMP280_SHM_MAX_SENSORS];
+    bmp280_i2c_address_t addresses[BMP280_SHM_MAX_SENSORS];
+    bmp280_error_code_t init_errors[BMP280_SHM_MAX_SENSORS];
+
+    for (int index = 1; index < argc && sensor_count < BMP280_SHM_MAX_SENSORS; index++)
+    {
+        addresses[sensor_count++] = (bmp280_i2c_address_t)strtol(argv[index], NULL, 16);
+    }
+
+    if (sensor_count == 0)
+    {
+        addresses[sensor_count++] = BMP280_I2C_ADDRESS_1;
+    }
+
+    const char *bus_path = getenv("I2C_DEV_PATH");
+
+    if (bmp280_i2c_bus_open(&bus, (bus_path != NULL) ? bus_path : default_i2c_bus_address) != 0)
+    {
+        return -1;
+    }
+    #if BMP280_INCLUDE_EXCLUSION_HOOK
+    bus.bmp280_bus_exclusion.bmp280_interface_lock = bmp280_mutex_lock;
+    bus.bmp280_bus_exclusion.bmp280_interface_unlock = bmp280_mutex_unlock;
+    bus.bmp280_bus_exclusion.mutex_handle = &bmp280_bus_mutex;
+    #endif
+
+    for (uint32_t index = 0; index < sensor_count; index++)
+    {
+        set_dependencies(&sensors[index]);
+        handles[index] = &sensors[index];
+    }
+
+    /*all sensors share one reset delay*/
+    bmp280_error_code_t error = bmp280_init_multiple(handles, BMP280_I2C, addresses, (uint8_t)sensor_count, init_errors);
+    if (error != BMP280_ERROR_OK)
+    {
+        for (uint32_t index = 0; index < sensor_count; index++)
+        {
+            if (init_errors[index] != BMP280_ERROR_OK)
+            {
+                printf("SENSOR 0x%02X: ERROR CODE: %d\n", (int)addresses[index], (int)init_errors[index]);
+            }
+        }
+        return (int)error;
+    }
+
+    for (uint32_t index = 0; index < sensor_count; index++)
+    {
+        error = configure_sensor(&sensors[index]);
+        if (error != BMP280_ERROR_OK)
+        {
+            printf("SENSOR 0x%02X: ERROR CODE: %d\n", (int)addresses[index], (int)error);
+            return (int)error;
+        }
+    }
+
+    bmp280_shm_t *shm = bmp280_shm_create(shm_name, sensor_count);
+    if (shm == NULL)
+    {
+        return -1;
+    }
+
+    action.sa_handler = stop_handler;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &next_wakeup);
+
+    while (running)
+    {
+        bmp280_sensors_data_t data[BMP280_SHM_MAX_SENSORS];
+
+        if (bmp280_bus_get_all(&bus, handles, data, (uint8_t)sensor_count) == BMP280_ERROR_OK)
+        {
+            for (uint32_t index = 0; index < sensor_count; index++)
+            {
+                bmp280_shm_publish(shm, index, (uint8_t)sensors[index].i2c_address, BMP280_ERROR_OK, &data[index]);
+            }
+        }
+        else
+        {
+            /*one sensor failed: read them one by one, so each slot gets its own result*/
+            for (uint32_t index = 0; index < sensor_count; index++)
+            {
+                bmp280_error_code_t error = bmp280_get_all(&sensors[index], &data[index]);
+
+                bmp280_shm_publish(shm, index, (uint8_t)sensors[index].i2c_address, error, (error == BMP280_ERROR_OK) ? &data[index] : NULL);
+            }
+        }
+
+        next_wakeup.tv_nsec += PUBLISH_PERIOD_NS;
+        if (next_wakeup.tv_nsec >= 1000000000L)
+        {
+            next_wakeup.tv_nsec -= 1000000000L;
+            next_wakeup.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next_wakeup, NULL);
+    }
+
+    for (uint32_t index = 0; index < sensor_count; index++)
+    {
+        bmp280_deinit(&sensors[index]);
+    }
+
+    printf("BUS: %u READS, %u WRITES, %u ERRORS, %u ADDRESS SWITCHES, %u LOCK HOLDS\n",
+        (unsigned)bus.statistics.reads, (unsigned)bus.statistics.writes, (unsigned)bus.statistics.errors,
+        (unsigned)bus.statistics.address_switches, (unsigned)bus.statistics.lock_holds);
+    bmp280_i2c_bus_close(&bus);
+
+    return bmp280_shm_destroy(shm, shm_name);
+}
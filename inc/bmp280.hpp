@@ -0,0 +1,499 @@
+/**
+* @file	bmp280.hpp
+* @brief BMP280 barometric pressure and temperature sensor C++ wrapper (header-only, C++17)
+* @author Reza G. Ebrahimi <https://github.com/ebrezadev>
+* @version 5.0
+* @Section HOW-TO-USE
+* The transport is a template parameter instead of a set of function pointers, so every
+* register access is a direct call the compiler can inline. A bus policy provides:
+*	@code
+*	struct my_bus
+*	{
+*		int init(uint8_t deviceAddress);
+*		int deinit(uint8_t deviceAddress);
+*		int read_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength);
+*		int write_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength);
+*		int delay_ms(uint32_t delayMS);
+*	};
+*	@endcode
+* All functions return 0 in case of no error, exactly like the C dependency interface. An empty
+* policy adds nothing to the size of the device. Mutual exclusion, if needed, belongs to the policy.
+*	@code
+*	auto sensor = bmp280::device<my_bus>::open(my_bus{}, BMP280_I2C, BMP280_I2C_ADDRESS_1);
+*	if(sensor)
+*	{
+*		auto data = sensor.value().get_all();
+*	}
+*	@endcode
+* The sensor is deinitialized when the device goes out of scope.
+*
+* @license MIT
+*
+* MIT License
+*
+* Copyright (c) 2025 Reza G. Ebrahimi
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#ifndef __BMP280_HPP__
+#define __BMP280_HPP__
+
+#include "bmp280_definitions.h"
+#include "bmp280_config.h"
+#include "bmp280_error.h"
+#include "bmp280_compensation.hpp"
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#if BMP280_INCLUDE_ALTITUDE
+#include <cmath>
+#endif
+
+namespace bmp280
+{
+
+/**
+ * @brief A value or the error that prevented it
+ *
+ */
+template <typename T>
+class result
+{
+public:
+	result(T value) : value_(std::move(value)), error_(BMP280_ERROR_OK) {}
+	result(bmp280_error_code_t error) : value_(), error_(error) {}
+
+	bool has_value() const { return value_.has_value(); }
+	explicit operator bool() const { return has_value(); }
+
+	T &value() & { return *value_; }
+	const T &value() const & { return *value_; }
+	T &&value() && { return std::move(*value_); }
+	T value_or(T fallback) const { return has_value() ? *value_ : fallback; }
+
+	bmp280_error_code_t error() const { return error_; }
+
+private:
+	std::optional<T> value_;
+	bmp280_error_code_t error_;
+};
+
+namespace detail
+{
+
+inline int32_t raw_20bit(const uint8_t *data)
+{
+	return (int32_t)((((uint32_t)data[0]) << 12) + (((uint32_t)data[1]) << 4) + (((uint32_t)data[2]) >> 4));
+}
+
+/*oversampling field of ctrl_meas; 0X06 and 0X07 also mean 16x*/
+inline bmp280_over_sampling_t oversampling_field(uint8_t osrs)
+{
+	return (osrs > (uint8_t)BMP280_OVERSAMPLING_16X) ? BMP280_OVERSAMPLING_16X : (bmp280_over_sampling_t)osrs;
+}
+
+}	/*namespace detail*/
+
+/**
+ * @brief A BMP280 sensor on a statically dispatched bus
+ *
+ * Move-only. Keeps a shadow of ctrl_meas and config, so setters are a single register write.
+ *
+ */
+template <typename Bus>
+class device : private Bus
+{
+public:
+	/**
+	 * @brief Initializes the interface and the sensor
+	 *
+	 * Checks the chip ID, resets the sensor, reads the calibration and programs the default
+	 * configuration, like bmp280_init().
+	 *
+	 * @param bus: The bus policy instance, moved into the device.
+	 * @param hw_interface: I2C, SPI or a software mock.
+	 * @param i2c_address: I2C address in case of I2C interface.
+	 * @return The device, or the error of the failing step.
+	 */
+	static result<device> open(Bus bus, bmp280_hardware_interface_t hw_interface, bmp280_i2c_address_t i2c_address)
+	{
+		device sensor(std::move(bus), (hw_interface == BMP280_I2C) ? i2c_address : BMP280_I2C_ADDRESS_NONE);
+
+		if (sensor.bus().init((uint8_t)sensor.i2c_address_) != 0)
+		{
+			return BMP280_ERROR_INTERFACE_INIT;
+		}
+		sensor.initialized_ = true;
+
+		if (bmp280_error_code_t error = sensor.start(); error != BMP280_ERROR_OK)
+		{
+			return error;
+		}
+
+		return result<device>(std::move(sensor));
+	}
+
+	device(const device &) = delete;
+	device &operator=(const device &) = delete;
+
+	device(device &&other) noexcept
+		: Bus(std::move(other.bus())),
+		  i2c_address_(other.i2c_address_),
+		  dig_(other.dig_),
+		  ctrl_meas_(other.ctrl_meas_),
+		  config_(other.config_),
+		  initialized_(std::exchange(other.initialized_, false))
+	{
+	}
+
+	device &operator=(device &&other) noexcept
+	{
+		if (this != &other)
+		{
+			close();
+			bus() = std::move(other.bus());
+			i2c_address_ = other.i2c_address_;
+			dig_ = other.dig_;
+			ctrl_meas_ = other.ctrl_meas_;
+			config_ = other.config_;
+			initialized_ = std::exchange(other.initialized_, false);
+		}
+
+		return *this;
+	}
+
+	~device()
+	{
+		close();
+	}
+
+	/**
+	 * @brief Resets the sensor and deinitializes the interface
+	 *
+	 * Called by the destructor; call it directly to see the error.
+	 *
+	 * @return 0 or ERROR_OK on success, other values on errors.
+	 */
+	bmp280_error_code_t close()
+	{
+		if (!initialized_)
+		{
+			return BMP280_ERROR_OK;
+		}
+		initialized_ = false;
+
+		bmp280_error_code_t error = write_register(BMP280_REGISTER_ADDRESS_RESET, BMP280_RESET_VALUE);
+		if (bus().deinit((uint8_t)i2c_address_) != 0 && error == BMP280_ERROR_OK)
+		{
+			error = BMP280_ERROR_INTERFACE_DEINIT;
+		}
+
+		return error;
+	}
+
+	bmp280_error_code_t set_mode(bmp280_operation_mode_t operationMode)
+	{
+		return write_ctrl_meas(field(ctrl_meas_, (uint8_t)operationMode, BMP280_REGISTER_BIT_MODE, BMP280_REGISTER_FIELD_LENGTH_MODE));
+	}
+
+	bmp280_error_code_t set_pressure_oversampling(bmp280_over_sampling_t osValue)
+	{
+		return reconfigure(BMP280_REGISTER_ADDRESS_CONTROL_MEAS, (uint8_t)osValue, BMP280_REGISTER_BIT_OSRS_P, BMP280_REGISTER_FIELD_LENGTH_OSRS_P);
+	}
+
+	bmp280_error_code_t set_temperature_oversampling(bmp280_over_sampling_t osValue)
+	{
+		return reconfigure(BMP280_REGISTER_ADDRESS_CONTROL_MEAS, (uint8_t)osValue, BMP280_REGISTER_BIT_OSRS_T, BMP280_REGISTER_FIELD_LENGTH_OSRS_T);
+	}
+
+	bmp280_error_code_t set_standby_time(bmp280_standby_time_t standbyTime)
+	{
+		return reconfigure(BMP280_REGISTER_ADDRESS_CONFIG, (uint8_t)standbyTime, BMP280_REGISTER_BIT_T_SB, BMP280_REGISTER_FIELD_LENGTH_T_SB);
+	}
+
+	bmp280_error_code_t set_filter_coefficient(bmp280_iir_filter_t filterCoefficient)
+	{
+		return reconfigure(BMP280_REGISTER_ADDRESS_CONFIG, (uint8_t)filterCoefficient, BMP280_REGISTER_BIT_FILTER, BMP280_REGISTER_FIELD_LENGTH_FILTER);
+	}
+
+	/*temperature in Centigrade*/
+	result<float> get_temperature()
+	{
+		uint8_t data[3];
+
+		if (bmp280_error_code_t error = acquire(BMP280_REGISTER_ADDRESS_TEMPERATURE_MSB, data, sizeof(data)); error != BMP280_ERROR_OK)
+		{
+			return error;
+		}
+
+		return temperature_from_t_fine(compensate_t_fine(dig_, detail::raw_20bit(data)));
+	}
+
+	/*pressure in Pascal. reads temperature in the same transfer, so it does not depend on an earlier call*/
+	result<uint32_t> get_pressure()
+	{
+		uint8_t data[6];
+
+		if (bmp280_error_code_t error = acquire(BMP280_REGISTER_ADDRESS_PRESSURE_MSB, data, sizeof(data)); error != BMP280_ERROR_OK)
+		{
+			return error;
+		}
+
+		return compensate_pressure(dig_, detail::raw_20bit(&data[0]), compensate_t_fine(dig_, detail::raw_20bit(&data[3])));
+	}
+
+	/*temperature, pressure and (optionally) altitude from a single burst read*/
+	result<bmp280_sensors_data_t> get_all()
+	{
+		uint8_t data[6];
+		bmp280_sensors_data_t sensors_data;
+
+		if (bmp280_error_code_t error = acquire(BMP280_REGISTER_ADDRESS_PRESSURE_MSB, data, sizeof(data)); error != BMP280_ERROR_OK)
+		{
+			return error;
+		}
+
+		int32_t t_fine = compensate_t_fine(dig_, detail::raw_20bit(&data[3]));
+
+		sensors_data.temperature = temperature_from_t_fine(t_fine);
+		sensors_data.pressure = compensate_pressure(dig_, detail::raw_20bit(&data[0]), t_fine);
+
+		#if BMP280_INCLUDE_ALTITUDE
+		sensors_data.altitude = 44307.69396 * (1 - 0.111555816 * std::pow((float)sensors_data.pressure, 0.190284f));
+		#endif
+
+		sensors_data.new_data = 1;
+
+		return sensors_data;
+	}
+
+	/*mode of operation, read back from the sensor*/
+	result<bmp280_operation_mode_t> get_mode()
+	{
+		uint8_t value;
+
+		if (bmp280_error_code_t error = read_registers(BMP280_REGISTER_ADDRESS_CONTROL_MEAS, &value, 1); error != BMP280_ERROR_OK)
+		{
+			return error;
+		}
+
+		switch (value & 0x03)
+		{
+		case 0x00:
+			return BMP280_MODE_SLEEP;
+		case 0x03:
+			return BMP280_MODE_NORMAL;
+		default:
+			return BMP280_MODE_FORCED;
+		}
+	}
+
+	const bmp280_calibration_param_t &calibration() const { return dig_; }
+	bmp280_i2c_address_t i2c_address() const { return i2c_address_; }
+
+private:
+	device(Bus &&bus, bmp280_i2c_address_t i2c_address)
+		: Bus(std::move(bus)), i2c_address_(i2c_address), dig_(), ctrl_meas_(0), config_(0), initialized_(false)
+	{
+	}
+
+	Bus &bus() { return *this; }
+
+	bmp280_error_code_t read_registers(uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
+	{
+		return (bus().read_array((uint8_t)i2c_address_, startRegisterAddress, data, dataLength) != 0) ? BMP280_ERROR_INTERFACE_READ : BMP280_ERROR_OK;
+	}
+
+	bmp280_error_code_t write_register(uint8_t registerAddress, uint8_t value)
+	{
+		return (bus().write_array((uint8_t)i2c_address_, registerAddress, &value, 1) != 0) ? BMP280_ERROR_INTERFACE_WRITE : BMP280_ERROR_OK;
+	}
+
+	bmp280_error_code_t delay(uint32_t delayMS)
+	{
+		return (bus().delay_ms(delayMS) != 0) ? BMP280_ERROR_INTERFACE_DELAY : BMP280_ERROR_OK;
+	}
+
+	static uint8_t field(uint8_t registerValue, uint8_t fieldData, bmp280_register_bit_t fieldStartBitAddress, bmp280_register_field_length_t fieldLength)
+	{
+		uint8_t mask = (uint8_t)(((1u << (uint8_t)fieldLength) - 1) << (uint8_t)fieldStartBitAddress);
+
+		return (uint8_t)((registerValue & ~mask) | ((fieldData << (uint8_t)fieldStartBitAddress) & mask));
+	}
+
+	bmp280_error_code_t write_ctrl_meas(uint8_t value)
+	{
+		bmp280_error_code_t error = write_register(BMP280_REGISTER_ADDRESS_CONTROL_MEAS, value);
+
+		if (error == BMP280_ERROR_OK)
+		{
+			ctrl_meas_ = value;
+		}
+
+		return error;
+	}
+
+	/*configuration is only written in sleep mode; the previous mode is restored afterwards*/
+	bmp280_error_code_t reconfigure(bmp280_register_address_t registerAddress, uint8_t fieldData, bmp280_register_bit_t fieldStartBitAddress, bmp280_register_field_length_t fieldLength)
+	{
+		uint8_t mode = ctrl_meas_ & 0x03;
+		bmp280_error_code_t error;
+
+		if (mode != BMP280_MODE_SLEEP)
+		{
+			if ((error = write_ctrl_meas(ctrl_meas_ & ~0x03)) != BMP280_ERROR_OK)
+			{
+				return error;
+			}
+		}
+
+		if (registerAddress == BMP280_REGISTER_ADDRESS_CONFIG)
+		{
+			uint8_t value = field(config_, fieldData, fieldStartBitAddress, fieldLength);
+
+			if ((error = write_register(BMP280_REGISTER_ADDRESS_CONFIG, value)) != BMP280_ERROR_OK)
+			{
+				return error;
+			}
+			config_ = value;
+
+			return (mode != BMP280_MODE_SLEEP) ? write_ctrl_meas(ctrl_meas_ | mode) : BMP280_ERROR_OK;
+		}
+
+		return write_ctrl_meas(field(ctrl_meas_, fieldData, fieldStartBitAddress, fieldLength) | mode);
+	}
+
+	/*chip ID, reset, calibration and default configuration*/
+	bmp280_error_code_t start()
+	{
+		uint8_t data[24];
+		bmp280_error_code_t error;
+
+		if ((error = read_registers(BMP280_REGISTER_ADDRESS_ID, data, 1)) != BMP280_ERROR_OK)
+		{
+			return error;
+		}
+		if (data[0] != BMP280_DEFAULT_CHIP_ID)
+		{
+			return BMP280_ERROR_SENSOR_ID;
+		}
+
+		if ((error = write_register(BMP280_REGISTER_ADDRESS_RESET, BMP280_RESET_VALUE)) != BMP280_ERROR_OK)
+		{
+			return error;
+		}
+		if ((error = delay(BMP280_STARTUP_DELAY_IN_MS)) != BMP280_ERROR_OK)
+		{
+			return error;
+		}
+
+		if ((error = read_registers(BMP280_REGISTER_ADDRESS_T1, data, sizeof(data))) != BMP280_ERROR_OK)
+		{
+			return error;
+		}
+		dig_.T1 = (uint16_t)(data[0] | (data[1] << 8));
+		dig_.T2 = (int16_t)(data[2] | (data[3] << 8));
+		dig_.T3 = (int16_t)(data[4] | (data[5] << 8));
+		dig_.P1 = (uint16_t)(data[6] | (data[7] << 8));
+		dig_.P2 = (int16_t)(data[8] | (data[9] << 8));
+		dig_.P3 = (int16_t)(data[10] | (data[11] << 8));
+		dig_.P4 = (int16_t)(data[12] | (data[13] << 8));
+		dig_.P5 = (int16_t)(data[14] | (data[15] << 8));
+		dig_.P6 = (int16_t)(data[16] | (data[17] << 8));
+		dig_.P7 = (int16_t)(data[18] | (data[19] << 8));
+		dig_.P8 = (int16_t)(data[20] | (data[21] << 8));
+		dig_.P9 = (int16_t)(data[22] | (data[23] << 8));
+
+		/*after the reset the sensor sleeps, so config can be written directly*/
+		config_ = field(0, (uint8_t)BMP280_STANDBY_TIME_DEFAULT, BMP280_REGISTER_BIT_T_SB, BMP280_REGISTER_FIELD_LENGTH_T_SB);
+		config_ = field(config_, (uint8_t)BMP280_FILTER_DEFAULT, BMP280_REGISTER_BIT_FILTER, BMP280_REGISTER_FIELD_LENGTH_FILTER);
+		if ((error = write_register(BMP280_REGISTER_ADDRESS_CONFIG, config_)) != BMP280_ERROR_OK)
+		{
+			return error;
+		}
+
+		uint8_t ctrl_meas = field(0, (uint8_t)BMP280_TEMPERATURE_OVERSAMPLING_DEFAULT, BMP280_REGISTER_BIT_OSRS_T, BMP280_REGISTER_FIELD_LENGTH_OSRS_T);
+		ctrl_meas = field(ctrl_meas, (uint8_t)BMP280_PRESSURE_OVERSAMPLING_DEFAULT, BMP280_REGISTER_BIT_OSRS_P, BMP280_REGISTER_FIELD_LENGTH_OSRS_P);
+		ctrl_meas = field(ctrl_meas, (uint8_t)BMP280_MODE_DEFAULT, BMP280_REGISTER_BIT_MODE, BMP280_REGISTER_FIELD_LENGTH_MODE);
+
+		return write_ctrl_meas(ctrl_meas);
+	}
+
+	/*in forced mode triggers a conversion and waits for it, then reads the data registers*/
+	bmp280_error_code_t acquire(uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
+	{
+		bmp280_error_code_t error;
+
+		if ((ctrl_meas_ & 0x03) == BMP280_MODE_FORCED || (ctrl_meas_ & 0x03) == 0x02)
+		{
+			if ((error = write_ctrl_meas(ctrl_meas_)) != BMP280_ERROR_OK)
+			{
+				return error;
+			}
+
+			uint32_t measurement_ms = (measurement_time_max_us(detail::oversampling_field(ctrl_meas_ >> BMP280_REGISTER_BIT_OSRS_T), detail::oversampling_field((ctrl_meas_ >> BMP280_REGISTER_BIT_OSRS_P) & 0x07)) + 999) / 1000;
+			if ((error = delay(measurement_ms)) != BMP280_ERROR_OK)
+			{
+				return error;
+			}
+		}
+
+		/*polling and waiting for new data with a timeout*/
+		for (uint32_t poll_timeout_us = BMP280_MEASURING_POLL_TIMEOUT_IN_US;;)
+		{
+			uint8_t status;
+
+			if ((error = read_registers(BMP280_REGISTER_ADDRESS_STATUS, &status, 1)) != BMP280_ERROR_OK)
+			{
+				return error;
+			}
+
+			if (((status >> BMP280_REGISTER_BIT_MEASURING) & 0x01) != BMP280_MEASURING_IN_PROGRESS)
+			{
+				break;
+			}
+
+			if (poll_timeout_us < (uint32_t)BMP280_MEASURING_POLL_PERIOD_IN_MS * 1000)
+			{
+				return BMP280_ERROR_SENSOR_POLL_TIMEOUT;
+			}
+			poll_timeout_us -= (uint32_t)BMP280_MEASURING_POLL_PERIOD_IN_MS * 1000;
+
+			if ((error = delay(BMP280_MEASURING_POLL_PERIOD_IN_MS)) != BMP280_ERROR_OK)
+			{
+				return error;
+			}
+		}
+
+		return read_registers(startRegisterAddress, data, dataLength);
+	}
+
+	bmp280_i2c_address_t i2c_address_;
+	bmp280_calibration_param_t dig_;
+	uint8_t ctrl_meas_;
+	uint8_t config_;
+	bool initialized_;
+};
+
+}	/*namespace bmp280*/
+
+#endif
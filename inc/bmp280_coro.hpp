@@ -0,0 +1,453 @@
+/**
+* @file	bmp280_coro.hpp
+* @brief BMP280 barometric pressure and temperature sensor C++20 coroutine API (header-only)
+* @author Reza G. Ebrahimi <https://github.com/ebrezadev>
+* @version 5.0
+* @Section HOW-TO-USE
+* Awaitable versions of the asynchronous reads of the C driver: a coroutine suspends where the
+* blocking functions would call the delay function, and resumes when the asynchronous transport
+* (bmp280_async_read, bmp280_async_write and bmp280_async_timer of the dependency interface)
+* completes the last step. Needs BMP280_INCLUDE_ASYNC, and a sensor initialized with bmp280_init().
+*	@code
+*	my_task read_sensor(bmp280_handle_t &sensor, my_executor executor)
+*	{
+*		auto data = co_await bmp280::coro::get_all(sensor, executor);
+*
+*		bmp280::coro::sample_stream<my_executor> stream(sensor, executor);
+*		for(;;)
+*		{
+*			auto sample = co_await stream.next();
+*		}
+*	}
+*	@endcode
+* The executor decides where the coroutine resumes. It is any copyable type with:
+*	@code
+*	void post(std::coroutine_handle<> coroutine);
+*	@endcode
+* called once from the completion of the transport. The default inline_executor resumes the
+* coroutine right there, in the context of the completion. The coroutine type itself (task,
+* fire and forget, ...) is left to the application. A handle is used by one operation at a time.
+*
+* @license MIT
+*
+* MIT License
+*
+* Copyright (c) 2025 Reza G. Ebrahimi
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+*
+*/
+
+#ifndef __BMP280_CORO_HPP__
+#define __BMP280_CORO_HPP__
+
+#include "bmp280.h"
+#include "bmp280.hpp"
+#include <coroutine>
+
+#if !BMP280_INCLUDE_ASYNC
+#error "bmp280_coro.hpp needs BMP280_INCLUDE_ASYNC"
+#endif
+
+namespace bmp280
+{
+namespace coro
+{
+
+/**
+ * @brief Resumes the coroutine in the context of the completion
+ *
+ */
+struct inline_executor
+{
+	void post(std::coroutine_handle<> coroutine) const
+	{
+		coroutine.resume();
+	}
+};
+
+/**
+ * @brief Awaitable temperature and pressure, see bmp280_get_all_async()
+ *
+ * Returned by get_all() and forced_measurement(). Not copyable: the transport refers to it
+ * until the coroutine resumes.
+ *
+ */
+template <typename Executor = inline_executor>
+class get_all_awaitable
+{
+public:
+	get_all_awaitable(bmp280_handle_t &handle, Executor executor, bmp280_error_code_t error = BMP280_ERROR_OK)
+		: handle_(&handle), executor_(executor), operation_(), data_(), error_(error)
+	{
+	}
+
+	get_all_awaitable(const get_all_awaitable &) = delete;
+	get_all_awaitable &operator=(const get_all_awaitable &) = delete;
+
+	/*an error found before the start, e.g. the wrong mode, does not suspend*/
+	bool await_ready() const noexcept
+	{
+		return error_ != BMP280_ERROR_OK;
+	}
+
+	bool await_suspend(std::coroutine_handle<> coroutine)
+	{
+		coroutine_ = coroutine;
+
+		/*once started, the coroutine may be resumed and this object gone before the call returns*/
+		bmp280_error_code_t error = bmp280_get_all_async(handle_, &operation_, &data_, done, this);
+		if (error != BMP280_ERROR_OK)
+		{
+			error_ = error;
+			return false;
+		}
+
+		return true;
+	}
+
+	result<bmp280_sensors_data_t> await_resume()
+	{
+		if (error_ != BMP280_ERROR_OK)
+		{
+			return error_;
+		}
+
+		return data_;
+	}
+
+private:
+	static void done(void *context, bmp280_error_code_t error)
+	{
+		get_all_awaitable *self = static_cast<get_all_awaitable *>(context);
+
+		self->error_ = error;
+		self->executor_.post(self->coroutine_);
+	}
+
+	bmp280_handle_t *handle_;
+	Executor executor_;
+	std::coroutine_handle<> coroutine_;
+	bmp280_async_operation_t operation_;
+	bmp280_sensors_data_t data_;
+	bmp280_error_code_t error_;
+};
+
+/**
+ * @brief Awaitable delay on the timer of the asynchronous transport
+ *
+ * Returned by sleep_for(). Resumes with 0 or ERROR_OK, or BMP280_ERROR_INTERFACE_DELAY.
+ *
+ */
+template <typename Executor = inline_executor>
+class sleep_awaitable
+{
+public:
+	sleep_awaitable(bmp280_handle_t &handle, uint32_t delayUS, Executor executor)
+		: handle_(&handle), delay_us_(delayUS), executor_(executor), error_(BMP280_ERROR_OK)
+	{
+	}
+
+	sleep_awaitable(const sleep_awaitable &) = delete;
+	sleep_awaitable &operator=(const sleep_awaitable &) = delete;
+
+	bool await_ready() const noexcept
+	{
+		return false;
+	}
+
+	bool await_suspend(std::coroutine_handle<> coroutine)
+	{
+		bmp280_async_timer_fp timer = handle_->dependency_interface.bmp280_async_timer;
+
+		coroutine_ = coroutine;
+
+		if (timer == NULL)
+		{
+			error_ = BMP280_ERROR_NULL_INTERFACE;
+			return false;
+		}
+
+		if (timer(delay_us_, complete, this) != 0)
+		{
+			error_ = BMP280_ERROR_INTERFACE_DELAY;
+			return false;
+		}
+
+		return true;
+	}
+
+	bmp280_error_code_t await_resume() const
+	{
+		return error_;
+	}
+
+private:
+	static void complete(void *context, int result)
+	{
+		sleep_awaitable *self = static_cast<sleep_awaitable *>(context);
+
+		self->error_ = (result != 0) ? BMP280_ERROR_INTERFACE_DELAY : BMP280_ERROR_OK;
+		self->executor_.post(self->coroutine_);
+	}
+
+	bmp280_handle_t *handle_;
+	uint32_t delay_us_;
+	Executor executor_;
+	std::coroutine_handle<> coroutine_;
+	bmp280_error_code_t error_;
+};
+
+/**
+ * @brief Reads temperature and pressure in any mode, like bmp280_get_all()
+ *
+ * In forced mode it is a complete forced measurement: trigger, conversion time, data read.
+ *
+ * @param handle: The BMP280 instance, not used by other calls until the coroutine resumes.
+ * @param executor: Resumes the coroutine.
+ * @return Awaitable of the sensor data or the error.
+ */
+template <typename Executor = inline_executor>
+get_all_awaitable<Executor> get_all(bmp280_handle_t &handle, Executor executor = Executor())
+{
+	return get_all_awaitable<Executor>(handle, executor);
+}
+
+/**
+ * @brief Triggers one conversion and reads it
+ *
+ * Same as get_all(), but fails with BMP280_ERROR_MODE_NOT_FORCED without a bus access
+ * outside forced mode, where a read would not start a conversion.
+ *
+ * @param handle: The BMP280 instance, not used by other calls until the coroutine resumes.
+ * @param executor: Resumes the coroutine.
+ * @return Awaitable of the sensor data or the error.
+ */
+template <typename Executor = inline_executor>
+get_all_awaitable<Executor> forced_measurement(bmp280_handle_t &handle, Executor executor = Executor())
+{
+	return get_all_awaitable<Executor>(handle, executor,
+		(handle.operation_mode == BMP280_MODE_FORCED) ? BMP280_ERROR_OK : BMP280_ERROR_MODE_NOT_FORCED);
+}
+
+/**
+ * @brief Suspends for a while on the timer of the asynchronous transport
+ *
+ * @param handle: The BMP280 instance whose timer is used.
+ * @param delayUS: The delay in microseconds.
+ * @param executor: Resumes the coroutine.
+ * @return Awaitable of 0 or ERROR_OK, other values on errors.
+ */
+template <typename Executor = inline_executor>
+sleep_awaitable<Executor> sleep_for(bmp280_handle_t &handle, uint32_t delayUS, Executor executor = Executor())
+{
+	return sleep_awaitable<Executor>(handle, delayUS, executor);
+}
+
+/**
+ * @brief New samples at the output data rate of the current configuration
+ *
+ * Each next() waits for the sample period (bmp280_get_timing()) since the last new sample,
+ * then reads. In forced mode the read itself takes the period, so reads follow each other.
+ * In normal mode a read that finds no new conversion is repeated every poll period until
+ * one appears, which keeps the reads just behind the conversions of the sensor. With the
+ * clock of the dependency interface the time spent in the reads is taken off the wait.
+ * Only one next() can be awaited at a time; the stream must outlive it.
+ *
+ */
+template <typename Executor = inline_executor>
+class sample_stream
+{
+public:
+	sample_stream(bmp280_handle_t &handle, Executor executor = Executor())
+		: handle_(&handle), executor_(executor), operation_(), data_(), error_(BMP280_ERROR_OK),
+		  started_(false), last_us_(0), repeated_us_(0)
+	{
+	}
+
+	sample_stream(const sample_stream &) = delete;
+	sample_stream &operator=(const sample_stream &) = delete;
+
+	class next_awaitable
+	{
+	public:
+		explicit next_awaitable(sample_stream &stream) : stream_(&stream) {}
+
+		bool await_ready() const noexcept
+		{
+			return false;
+		}
+
+		bool await_suspend(std::coroutine_handle<> coroutine)
+		{
+			return stream_->start(coroutine);
+		}
+
+		result<bmp280_sensors_data_t> await_resume()
+		{
+			return stream_->finish();
+		}
+
+	private:
+		sample_stream *stream_;
+	};
+
+	/**
+	 * @brief Waits for the next new sample
+	 *
+	 * @return Awaitable of the sensor data or the error. After a poll timeout or any other
+	 * error, the next call starts over without waiting.
+	 */
+	next_awaitable next()
+	{
+		return next_awaitable(*this);
+	}
+
+private:
+	uint32_t now_us() const
+	{
+		bmp280_clock_us_fp clock = handle_->dependency_interface.bmp280_clock_us;
+
+		return (clock != NULL) ? clock() : 0;
+	}
+
+	/*returns false when nothing was started: the coroutine goes on with error_ set*/
+	bool start(std::coroutine_handle<> coroutine)
+	{
+		bmp280_timing_t timing;
+		uint32_t delay_us = 0;
+
+		coroutine_ = coroutine;
+		error_ = BMP280_ERROR_OK;
+		repeated_us_ = 0;
+
+		if (started_ && handle_->operation_mode == BMP280_MODE_NORMAL)
+		{
+			if ((error_ = bmp280_get_timing(handle_, &timing)) != BMP280_ERROR_OK)
+			{
+				return false;
+			}
+			delay_us = timing.sample_period_us;
+
+			/*unsigned difference, correct across a wraparound of the clock*/
+			if (handle_->dependency_interface.bmp280_clock_us != NULL)
+			{
+				uint32_t elapsed_us = now_us() - last_us_;
+
+				delay_us = (elapsed_us < delay_us) ? (delay_us - elapsed_us) : 0;
+			}
+		}
+
+		bmp280_error_code_t error = (delay_us != 0) ? wait(delay_us) : read();
+		if (error != BMP280_ERROR_OK)
+		{
+			error_ = error;
+			return false;
+		}
+
+		return true;
+	}
+
+	result<bmp280_sensors_data_t> finish()
+	{
+		if (error_ != BMP280_ERROR_OK)
+		{
+			started_ = false;
+			return error_;
+		}
+
+		return data_;
+	}
+
+	bmp280_error_code_t wait(uint32_t delayUS)
+	{
+		bmp280_async_timer_fp timer = handle_->dependency_interface.bmp280_async_timer;
+
+		if (timer == NULL)
+		{
+			return BMP280_ERROR_NULL_INTERFACE;
+		}
+
+		return (timer(delayUS, waited, this) != 0) ? BMP280_ERROR_INTERFACE_DELAY : BMP280_ERROR_OK;
+	}
+
+	bmp280_error_code_t read()
+	{
+		last_us_ = now_us();
+
+		return bmp280_get_all_async(handle_, &operation_, &data_, done, this);
+	}
+
+	void resume(bmp280_error_code_t error)
+	{
+		error_ = error;
+		executor_.post(coroutine_);
+	}
+
+	static void waited(void *context, int result)
+	{
+		sample_stream *self = static_cast<sample_stream *>(context);
+		bmp280_error_code_t error = (result != 0) ? BMP280_ERROR_INTERFACE_DELAY : self->read();
+
+		if (error != BMP280_ERROR_OK)
+		{
+			self->resume(error);
+		}
+	}
+
+	static void done(void *context, bmp280_error_code_t error)
+	{
+		sample_stream *self = static_cast<sample_stream *>(context);
+		const uint32_t poll_period_us = (uint32_t)BMP280_MEASURING_POLL_PERIOD_IN_MS * 1000;
+
+		if (error == BMP280_ERROR_OK && !self->data_.new_data)
+		{
+			if (self->repeated_us_ + poll_period_us > BMP280_MEASURING_POLL_TIMEOUT_IN_US)
+			{
+				error = BMP280_ERROR_SENSOR_POLL_TIMEOUT;
+			}
+			else
+			{
+				self->repeated_us_ += poll_period_us;
+				if ((error = self->wait(poll_period_us)) == BMP280_ERROR_OK)
+				{
+					return;
+				}
+			}
+		}
+
+		self->started_ = (error == BMP280_ERROR_OK);
+		self->resume(error);
+	}
+
+	bmp280_handle_t *handle_;
+	Executor executor_;
+	std::coroutine_handle<> coroutine_;
+	bmp280_async_operation_t operation_;
+	bmp280_sensors_data_t data_;
+	bmp280_error_code_t error_;
+	bool started_;
+	uint32_t last_us_;		/*start of the read that found the last new sample*/
+	uint32_t repeated_us_;		/*poll periods spent on reads without a new sample*/
+};
+
+}	/*namespace coro*/
+}	/*namespace bmp280*/
+
+#endif
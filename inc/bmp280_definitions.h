@@ -37,6 +37,7 @@ extern "C" {
 #endif
 
 #include "bmp280_config.h"
+#include "bmp280_error.h"
 
 #ifndef NULL
 	#ifdef __cplusplus
@@ -214,6 +215,25 @@ typedef struct
 	int16_t P9;
 } bmp280_calibration_param_t;
 
+#if BMP280_INCLUDE_WARM_START
+
+/**
+ * @brief Snapshot of a configured sensor, used for a warm start
+ * 
+ * Filled by bmp280_save_warm_start_cache(). The application keeps it in a file or any
+ * other storage that survives a restart of the process.
+ * 
+ */
+typedef struct
+{
+	bmp280_calibration_param_t dig;
+	uint8_t ctrl_meas;
+	uint8_t config;
+	uint32_t calibration_hash;
+} bmp280_warm_start_cache_t;
+
+#endif
+
 /**
  * @brief Structure needed in case of using bmp280_get_all() function
  * 
@@ -226,8 +246,182 @@ typedef struct
 	#if BMP280_INCLUDE_ALTITUDE
 	float altitude;
 	#endif
+
+	uint8_t new_data;		/*0 if the sensor had no new conversion since the last read (normal mode): the values are the cached ones*/
 } bmp280_sensors_data_t;
 
+/**
+ * @brief Recommended settings of the datasheet for typical use cases
+ * 
+ */
+typedef enum
+{
+	BMP280_PROFILE_HANDHELD_LOW_POWER = 0X00,
+	BMP280_PROFILE_HANDHELD_DYNAMIC,
+	BMP280_PROFILE_WEATHER_MONITORING,
+	BMP280_PROFILE_ELEVATOR_DETECTION,
+	BMP280_PROFILE_DROP_DETECTION,
+	BMP280_PROFILE_INDOOR_NAVIGATION
+} bmp280_usage_profile_t;
+
+/**
+ * @brief The complete measurement configuration, held in ctrl_meas and config
+ * 
+ */
+typedef struct
+{
+	bmp280_operation_mode_t operation_mode;
+	bmp280_over_sampling_t pressure_oversampling;
+	bmp280_over_sampling_t temperature_oversampling;
+	bmp280_iir_filter_t filter_coefficient;
+	bmp280_standby_time_t standby_time;
+} bmp280_settings_t;
+
+/**
+ * @brief A usage profile: its settings and what to expect from them
+ * 
+ */
+typedef struct
+{
+	bmp280_settings_t settings;
+	float odr_hz;			/*output data rate. in forced mode, the rate the application is expected to trigger at*/
+	float rms_noise_cm;		/*RMS noise of the altitude*/
+	float current_ua;		/*typical average current, estimated from the measurement and standby times*/
+} bmp280_profile_t;
+
+/**
+ * @brief Conversion timing of a configuration (datasheet chapter 3.8)
+ * 
+ */
+typedef struct
+{
+	uint32_t measurement_time_typical_us;
+	uint32_t measurement_time_max_us;
+	uint32_t standby_time_us;		/*0 outside normal mode*/
+	uint32_t sample_period_us;		/*normal mode: typical measurement plus standby. otherwise: the maximum measurement time, the shortest safe forced mode period*/
+	float odr_hz;				/*new samples per second at that period*/
+} bmp280_timing_t;
+
+/**
+ * @brief How the driver waits for the end of a conversion
+ * 
+ */
+typedef enum
+{
+	BMP280_WAIT_SLEEP = 0X00,		/*sleep for the maximum measurement time, then poll with sleeps in between*/
+	BMP280_WAIT_SLEEP_THEN_SPIN,		/*sleep until the spin margin before the typical measurement time, spin on the clock to it, then poll back to back*/
+	BMP280_WAIT_SPIN			/*spin on the clock until the typical measurement time, then poll back to back*/
+} bmp280_wait_policy_t;
+
+/*Usage profiles section, indexed by bmp280_usage_profile_t (datasheet table 7)*/
+static const bmp280_profile_t BMP280_PROFILES[] = {
+	{{BMP280_MODE_NORMAL, BMP280_OVERSAMPLING_16X, BMP280_OVERSAMPLING_2X, BMP280_FILTER_4X, BMP280_T_STANDBY_62500US}, 10.0f, 4.0f, 247.0f},
+	{{BMP280_MODE_NORMAL, BMP280_OVERSAMPLING_4X, BMP280_OVERSAMPLING_1X, BMP280_FILTER_16X, BMP280_T_STANDBY_500US}, 83.3f, 2.4f, 564.0f},
+	{{BMP280_MODE_FORCED, BMP280_OVERSAMPLING_1X, BMP280_OVERSAMPLING_1X, BMP280_FILTER_OFF, BMP280_T_STANDBY_500US}, 1.0f / 60.0f, 26.4f, 0.14f},
+	{{BMP280_MODE_NORMAL, BMP280_OVERSAMPLING_4X, BMP280_OVERSAMPLING_1X, BMP280_FILTER_4X, BMP280_T_STANDBY_125MS}, 7.3f, 6.4f, 50.0f},
+	{{BMP280_MODE_NORMAL, BMP280_OVERSAMPLING_2X, BMP280_OVERSAMPLING_1X, BMP280_FILTER_OFF, BMP280_T_STANDBY_500US}, 125.0f, 20.8f, 486.0f},
+	{{BMP280_MODE_NORMAL, BMP280_OVERSAMPLING_16X, BMP280_OVERSAMPLING_2X, BMP280_FILTER_16X, BMP280_T_STANDBY_500US}, 26.3f, 1.6f, 650.0f}
+};
+
+#if BMP280_INCLUDE_SCHEDULER
+
+/**
+ * @brief State of the normal mode read scheduler
+ * 
+ * Set up by bmp280_scheduler_init(). Times are in microseconds of the application's
+ * clock and may wrap around.
+ * 
+ */
+typedef struct
+{
+	uint32_t nominal_period_us;			/*typical measurement plus standby*/
+	uint32_t sample_period_us;			/*the nominal period, adjusted to the sensor's oscillator*/
+	uint32_t measurement_time_us;			/*typical measurement time; half of it is the poll period while the phase is searched*/
+	uint32_t guard_us;				/*margin after the expected end of a conversion: maximum minus typical measurement time*/
+	uint32_t next_conversion_end_us;		/*while not synced: time of the next poll*/
+	uint8_t synced;					/*the phase of the conversions is known*/
+	uint8_t measuring_seen;				/*while not synced: the last poll found a conversion in progress*/
+	uint32_t reads;					/*bus reads*/
+	uint32_t misses;				/*samples overwritten before they were read*/
+	uint32_t duplicates;				/*calls that found no new sample*/
+	uint32_t resyncs;				/*times the phase was lost and searched again*/
+} bmp280_scheduler_t;
+
+#endif
+
+#if BMP280_INCLUDE_HEALTH_MONITOR
+
+/**
+ * @brief Faults found by the health monitor
+ *
+ */
+typedef enum
+{
+	BMP280_FAULT_NONE = 0X00,
+	BMP280_FAULT_SKIPPED,		/*a data register holds 0x80000, the value of a skipped conversion or of a sensor that was reset*/
+	BMP280_FAULT_STUCK,		/*the normal mode data registers did not change for stuck_limit reads in a row*/
+	BMP280_FAULT_REGISTERS,		/*ctrl_meas or config differ from the values last written*/
+	BMP280_FAULT_SLEW		/*pressure or temperature moved further than the slew limit since the last accepted sample*/
+} bmp280_fault_t;
+
+/**
+ * @brief Limits of the health monitor. A limit of 0 turns its check off
+ *
+ */
+typedef struct
+{
+	uint16_t stuck_limit;			/*normal mode reads with identical data registers that make a fault: more than the reads per conversion*/
+	uint16_t register_check_interval;	/*samples between reads of ctrl_meas and config of their own, 0 to read them only after a fault*/
+	uint32_t pressure_slew_limit;		/*in Pa between two accepted samples*/
+	uint16_t temperature_slew_limit;	/*in 0.01 Centigrade between two accepted samples*/
+	uint8_t auto_recover;			/*writes ctrl_meas and config again when they were lost, and resets the sensor when that does not help*/
+} bmp280_health_settings_t;
+
+/**
+ * @brief Fault counters of the health monitor
+ *
+ */
+typedef struct
+{
+	bmp280_fault_t last_fault;
+	uint32_t skipped;		/*samples with a 0x80000 data register*/
+	uint32_t stuck;			/*runs of identical normal mode reads that reached the stuck limit*/
+	uint32_t register_faults;	/*ctrl_meas/config mismatches*/
+	uint32_t slew_faults;		/*samples rejected by a slew limit*/
+	uint32_t restores;		/*ctrl_meas/config written again*/
+	uint32_t resets;		/*soft resets*/
+} bmp280_health_status_t;
+
+/**
+ * @brief State of the health monitor of a handle
+ *
+ * Set up by bmp280_set_health_monitor(). The checks run on the registers a read already
+ * transfers; ctrl_meas and config are read only after a fault, or every
+ * register_check_interval samples.
+ *
+ */
+typedef struct
+{
+	uint8_t enabled;
+	bmp280_health_settings_t settings;
+	bmp280_health_status_t status;
+	uint16_t identical_reads;		/*normal mode reads in a row that found the data registers unchanged*/
+	uint16_t samples_to_check;		/*samples until the next periodic ctrl_meas/config read*/
+	bmp280_fault_t check_reason;		/*the fault that made the next ctrl_meas/config check due, BMP280_FAULT_NONE for a periodic one*/
+	uint8_t check_due;			/*a ctrl_meas/config read is due*/
+	uint8_t restored;			/*ctrl_meas/config were written again and no good sample came since*/
+	uint8_t reset_pending;			/*a soft reset is due, run by bmp280_health_recover()*/
+	uint8_t reference_valid;
+	uint8_t suspect_valid;
+	uint8_t sample_rejected;		/*the slew limit rejected the last new sample: its repeated reads are rejected too*/
+	uint32_t reference_pressure;		/*the last accepted sample*/
+	float reference_temperature;
+	uint32_t suspect_pressure;		/*the last rejected sample: a step to it is confirmed by the next sample*/
+	float suspect_temperature;
+} bmp280_health_monitor_t;
+
+#endif
+
 /*Default values section*/
 static const bmp280_over_sampling_t BMP280_PRESSURE_OVERSAMPLING_DEFAULT = BMP280_OVERSAMPLING_1X;
 static const bmp280_over_sampling_t BMP280_TEMPERATURE_OVERSAMPLING_DEFAULT = BMP280_OVERSAMPLING_1X;
@@ -269,6 +463,30 @@ typedef int (*bmp280_interface_deinit_fp)(uint8_t deviceAddress);
  */
 typedef int (*bmp280_delay_function_fp)(uint32_t delayMS);
 
+
+/**
+ * @brief The monotonic clock
+ * 
+ * Optional. Returns a monotonic time in microseconds, which may wrap around at 2^32. With a
+ * clock, waits and timeouts are deadlines: bus time and oversleeping count against them.
+ * 
+ * @return Returns the current time in microseconds
+ * 
+ */
+typedef uint32_t (*bmp280_clock_us_fp)(void);
+
+
+/**
+ * @brief The microsecond delay function
+ * 
+ * Optional. Implements a delay function in microseconds. Used instead of the millisecond delay
+ * function when set, so no wait is rounded up to a whole millisecond.
+ * 
+ * @return Returns 0 for no error
+ * 
+ */
+typedef int (*bmp280_delay_us_function_fp)(uint32_t delayUS);
+
 #if BMP280_INCLUDE_ALTITUDE 
 
 /**
@@ -354,6 +572,146 @@ typedef struct
 
 #endif
 
+#if BMP280_INCLUDE_SHARED_BUS
+
+/**
+ * @brief The bus read function
+ * 
+ * Implements a read on a shared bus. The context is the one of the bus object, e.g. a file descriptor.
+ * 
+ * @param context: The bus object's transport context
+ * @param deviceAddress: Used in case of I2C interface
+ * @param startRegisterAddress: The address of starting register
+ * @param data: Pointer to the array of data
+ * @param dataLength: Length of data array
+ * @return Returns 0 for no error
+ * 
+ */
+typedef int (*bmp280_bus_read_fp)(void *context, uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength);
+
+
+/**
+ * @brief The bus write function
+ * 
+ * Implements a write on a shared bus. The context is the one of the bus object, e.g. a file descriptor.
+ * 
+ * @param context: The bus object's transport context
+ * @param deviceAddress: Used in case of I2C interface
+ * @param startRegisterAddress: The address of starting register
+ * @param data: Pointer to the array of data
+ * @param dataLength: Length of data array
+ * @return Returns 0 for no error
+ * 
+ */
+typedef int (*bmp280_bus_write_fp)(void *context, uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength);
+
+
+/**
+ * @brief Transaction statistics of a shared bus
+ * 
+ */
+typedef struct
+{
+	uint32_t reads;
+	uint32_t writes;
+	uint32_t bytes_read;
+	uint32_t bytes_written;
+	uint32_t errors;
+	uint32_t address_switches;		/*transfers to another device than the previous transfer*/
+	uint32_t lock_holds;		/*critical sections; a coalesced read of several devices is one*/
+} bmp280_bus_statistics_t;
+
+
+/**
+ * @brief A bus shared by several devices
+ * 
+ * One transport and one lock for all handles attached to the bus. Zero it, then set the transport
+ * (and the exclusion hooks). The application opens and closes the transport; the interface init and
+ * deinit of attached handles are not used.
+ * 
+ */
+typedef struct
+{
+	void *context;
+	bmp280_bus_read_fp bmp280_bus_read;
+	bmp280_bus_write_fp bmp280_bus_write;
+
+	#if BMP280_INCLUDE_EXCLUSION_HOOK
+	bmp280_interface_exclusion_t bmp280_bus_exclusion;
+	#endif
+
+	uint8_t current_address;		/*device of the last transfer, 0 for none*/
+	bmp280_bus_statistics_t statistics;
+} bmp280_bus_t;
+
+#endif
+
+
+#if BMP280_INCLUDE_ASYNC
+
+/**
+ * @brief The completion of an asynchronous transfer or timer
+ * 
+ * Called by the transport exactly once per submitted transfer or timer, from any thread or
+ * interrupt, possibly before the submit function returns.
+ * 
+ * @param context: The context given at submission
+ * @param result: 0 for no error
+ * 
+ */
+typedef void (*bmp280_async_complete_fp)(void *context, int result);
+
+
+/**
+ * @brief The asynchronous read function
+ * 
+ * Starts a read (e.g. with DMA) and returns without waiting for it. The data array must be
+ * filled before complete is called.
+ * 
+ * @param deviceAddress: Used in case of I2C interface
+ * @param startRegisterAddress: The address of starting register
+ * @param data: Pointer to the array of data
+ * @param dataLength: Length of data array
+ * @param complete: Called when the transfer is over
+ * @param context: Passed to complete
+ * @return Returns 0 if the transfer was submitted; complete is not called otherwise
+ * 
+ */
+typedef int (*bmp280_async_read_fp)(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength, bmp280_async_complete_fp complete, void *context);
+
+
+/**
+ * @brief The asynchronous write function
+ * 
+ * Starts a write and returns without waiting for it.
+ * 
+ * @param deviceAddress: Used in case of I2C interface
+ * @param startRegisterAddress: The address of starting register
+ * @param data: Pointer to the array of data, valid until complete is called
+ * @param dataLength: Length of data array
+ * @param complete: Called when the transfer is over
+ * @param context: Passed to complete
+ * @return Returns 0 if the transfer was submitted; complete is not called otherwise
+ * 
+ */
+typedef int (*bmp280_async_write_fp)(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength, bmp280_async_complete_fp complete, void *context);
+
+
+/**
+ * @brief The asynchronous timer function
+ * 
+ * Calls complete once the delay has passed, instead of blocking like the delay function.
+ * 
+ * @param delayUS: Delay in microseconds
+ * @param complete: Called when the delay is over
+ * @param context: Passed to complete
+ * @return Returns 0 if the timer was started; complete is not called otherwise
+ * 
+ */
+typedef int (*bmp280_async_timer_fp)(uint32_t delayUS, bmp280_async_complete_fp complete, void *context);
+
+#endif
+
 
 /**
  * @brief The dependency interface structure
@@ -376,6 +734,15 @@ typedef struct
 	#if BMP280_INCLUDE_EXCLUSION_HOOK
 	bmp280_interface_exclusion_t bmp280_interface_exclusion;
 	#endif
+
+	bmp280_clock_us_fp bmp280_clock_us;		/*optional; NULL: a timeout is counted in delay calls*/
+	bmp280_delay_us_function_fp bmp280_delay_us_function;		/*optional; NULL: waits are rounded up to milliseconds*/
+
+	#if BMP280_INCLUDE_ASYNC
+	bmp280_async_read_fp bmp280_async_read;		/*optional, all three are needed by the asynchronous reads*/
+	bmp280_async_write_fp bmp280_async_write;
+	bmp280_async_timer_fp bmp280_async_timer;
+	#endif
 } bmp280_dependency_t;
 
 
@@ -390,12 +757,81 @@ typedef struct
 	bmp280_operation_mode_t operation_mode;
 	bmp280_i2c_address_t i2c_address;
 	bmp280_calibration_param_t dig;
-	int32_t t_fine;
-	uint8_t poll_timeout_ms;
+	uint8_t ctrl_meas;		/*last value written to ctrl_meas*/
+	uint8_t config;		/*last value written to config*/
+	uint8_t last_raw[6];		/*pressure and temperature registers of the last compensated sample*/
+	uint8_t last_raw_valid;
+	uint8_t forced_pending;		/*bmp280_get_all_pipelined() started a forced conversion that was not read yet*/
+	bmp280_sensors_data_t last_data;		/*the result of last_raw*/
+	uint8_t temperature_interval;		/*bmp280_get_all() reads temperature every this many samples, 1 for always*/
+	uint8_t temperature_countdown;		/*samples left until the next temperature read*/
+	uint16_t temperature_drift_limit;		/*in 0.01 Centigrade: a larger change between two temperature reads makes the next sample read temperature too*/
+	bmp280_wait_policy_t wait_policy;		/*BMP280_WAIT_SLEEP unless set by bmp280_set_wait_policy()*/
+	uint16_t spin_margin_us;		/*BMP280_WAIT_SLEEP_THEN_SPIN: the part of a wait spent spinning*/
 	bmp280_hardware_interface_t hardware_interface;
 	bmp280_dependency_t dependency_interface;
+
+	#if BMP280_INCLUDE_SHARED_BUS
+	bmp280_bus_t *bus;		/*NULL: transport and lock of the dependency interface*/
+	#endif
+
+	#if BMP280_INCLUDE_HEALTH_MONITOR
+	bmp280_health_monitor_t health;		/*off unless set by bmp280_set_health_monitor()*/
+	#endif
+
+	#if BMP280_INCLUDE_ASYNC
+	uint8_t async_busy;		/*bmp280_get_all_async() runs an operation on this handle*/
+	#endif
 } bmp280_handle_t;
 
+#if BMP280_INCLUDE_ASYNC
+
+/**
+ * @brief What an asynchronous operation waits for
+ * 
+ */
+typedef enum
+{
+	BMP280_ASYNC_IDLE = 0X00,
+	BMP280_ASYNC_TRIGGER,		/*ctrl_meas write of a forced conversion*/
+	BMP280_ASYNC_CONVERSION,		/*timer: conversion time or poll period*/
+	BMP280_ASYNC_STATUS,		/*status read*/
+	BMP280_ASYNC_DATA		/*data registers read*/
+} bmp280_async_step_t;
+
+
+/**
+ * @brief The completion of an asynchronous operation
+ * 
+ * @param context: The context given to the operation
+ * @param error: 0 or ERROR_OK on success, other values on errors
+ * 
+ */
+typedef void (*bmp280_async_done_fp)(void *context, bmp280_error_code_t error);
+
+
+/**
+ * @brief An asynchronous read in progress
+ * 
+ * Storage of one operation, owned by the application. It must stay valid until done is called
+ * and must not be shared by two operations at a time.
+ * 
+ */
+typedef struct
+{
+	bmp280_handle_t *handle;
+	bmp280_sensors_data_t *data;
+	bmp280_async_done_fp done;
+	void *context;
+	bmp280_async_step_t step;
+	uint8_t buffer[6];		/*ctrl_meas to write, status or data registers*/
+	uint8_t length;		/*bytes of the data read*/
+	uint32_t start_us;		/*time of the first status read, on the clock dependency*/
+	uint32_t slept_us;		/*poll periods waited, for the timeout without a clock*/
+} bmp280_async_operation_t;
+
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -44,14 +44,14 @@
 #if BMP280_INCLUDE_EXCLUSION_HOOK 
 #define BMP280_LOCK(handle) \
 	do { \
-		if(handle->dependency_interface.bmp280_interface_exclusion.bmp280_interface_lock(handle->dependency_interface.bmp280_interface_exclusion.mutex_handle) != 0) \
+		if(bmp280_exclusion_lock(handle) != 0) \
 		{ \
 			return BMP280_ERROR_EXCLUSION_LOCK; \
 		} \
 	} while(0)
 #define BMP280_UNLOCK(handle) \
 	do { \
-		if(handle->dependency_interface.bmp280_interface_exclusion.bmp280_interface_unlock(handle->dependency_interface.bmp280_interface_exclusion.mutex_handle) != 0) \
+		if(bmp280_exclusion_unlock(handle) != 0) \
 		{ \
 			return BMP280_ERROR_EXCLUSION_UNLOCK; \
 		} \
@@ -62,19 +62,140 @@
 #endif
 
 
+/*Calibration parameters T1..P9 in the chip's non volatile memory*/
+#define BMP280_CALIBRATION_DATA_LENGTH 24
+
 /*Static functions are used internally*/
+/*Functions that wait (reset, mode changes, conversions) take the exclusion hook for each bus access and release it
+before waiting; they are called without the hook. All other static functions access the bus with the hook already held*/
+
+/*Checks the handle and its dependency interface*/
+static bmp280_error_code_t bmp280_check_dependencies(bmp280_handle_t *handle);
+#if BMP280_INCLUDE_EXCLUSION_HOOK
+/*Lock and unlock hooks of the handle, or of its bus*/
+static int bmp280_exclusion_lock(bmp280_handle_t *handle);
+static int bmp280_exclusion_unlock(bmp280_handle_t *handle);
+#endif
+#if BMP280_INCLUDE_SHARED_BUS
+/*A read or write through the bus object's transport, with statistics*/
+static bmp280_error_code_t bmp280_bus_transfer(bmp280_bus_t *bus, uint8_t deviceAddress, uint8_t registerAddress, uint8_t *data, uint8_t length, uint8_t write);
+/*Counts a finished transfer in the bus statistics*/
+static void bmp280_bus_count_transfer(bmp280_bus_t *bus, uint8_t deviceAddress, uint8_t length, uint8_t write, int result);
+#endif
+/*Initializes the hardware interface and checks the chip ID*/
+static bmp280_error_code_t bmp280_start_interface(bmp280_handle_t *handle, bmp280_hardware_interface_t hw_interface, bmp280_i2c_address_t i2c_address);
+/*Resets the sensor, gets the calibration and sets the default configuration. Waits*/
+static bmp280_error_code_t bmp280_cold_start(bmp280_handle_t *handle);
+/*Checks the handle, initializes its interface and resets the sensor, without the startup delay*/
+static bmp280_error_code_t bmp280_start_and_reset(bmp280_handle_t *handle, bmp280_hardware_interface_t hw_interface, bmp280_i2c_address_t i2c_address);
+/*Gets the calibration and sets the default configuration of a sensor that has started up*/
+static bmp280_error_code_t bmp280_calibrate_and_configure(bmp280_handle_t *handle);
+#if BMP280_INCLUDE_WARM_START
+/*Takes over a running sensor that matches the cache, or cold starts it. Waits*/
+static bmp280_error_code_t bmp280_adopt_or_cold_start(bmp280_handle_t *handle, bmp280_warm_start_cache_t *cache);
+static bmp280_error_code_t bmp280_fill_warm_start_cache(bmp280_handle_t *handle, bmp280_warm_start_cache_t *cache);
+#endif
+/*Soft reset and startup delay. Waits*/
+static bmp280_error_code_t bmp280_soft_reset(bmp280_handle_t *handle);
+static bmp280_error_code_t bmp280_read_chip_id(bmp280_handle_t *handle);
+/*Sets the mode bits of ctrl_meas. Waits*/
+static bmp280_error_code_t bmp280_write_mode(bmp280_handle_t *handle, bmp280_operation_mode_t operationMode);
+/*Changes a configuration field in sleep mode and restores the mode afterwards. Waits*/
+static bmp280_error_code_t bmp280_set_field_in_sleep(bmp280_handle_t *handle, bmp280_register_address_t registerAddress, uint8_t fieldData, bmp280_register_bit_t fieldStartBitAddress, bmp280_register_field_length_t fieldLength);
+/*Writes config and ctrl_meas from a settings structure*/
+static bmp280_error_code_t bmp280_write_settings(bmp280_handle_t *handle, const bmp280_settings_t *settings);
+/*Writes the default config and ctrl_meas directly, once the sensor is in sleep mode after a reset*/
+static bmp280_error_code_t bmp280_write_default_configuration(bmp280_handle_t *handle);
+/*Writes a whole register*/
+static bmp280_error_code_t bmp280_write_register(bmp280_handle_t *handle, bmp280_register_address_t registerAddress, uint8_t value);
+
+/*Keeps the copy of ctrl_meas and config in the handle up to date after a write*/
+static void bmp280_update_shadow_register(bmp280_handle_t *handle, bmp280_register_address_t registerAddress, uint8_t value);
 
 /*Sets a field of bits inside a BMP280 register*/
 static bmp280_error_code_t bmp280_set_bits_in_register(bmp280_handle_t *handle, bmp280_register_address_t registerAddress, uint8_t fieldData, bmp280_register_bit_t fieldStartBitAddress, bmp280_register_field_length_t fieldLength);
 static bmp280_error_code_t bmp280_get_bits_in_register(bmp280_handle_t *handle, bmp280_register_address_t registerAddress, uint8_t *fieldData, bmp280_register_bit_t fieldStartBitAddress, bmp280_register_field_length_t fieldLength);
 /*Gets calibration data. Must be done once in startup.*/
 static bmp280_error_code_t bmp280_get_calibration(bmp280_handle_t *handle);
-/*Gets raw temperature data. needs further processing.*/
-static bmp280_error_code_t bmp280_raw_temperature_data(bmp280_handle_t *handle, int32_t *raw_data);
-/*Gets raw pressure data. needs further processing.*/
-static bmp280_error_code_t bmp280_raw_pressure_data(bmp280_handle_t *handle, int32_t *raw_data);
-static bmp280_error_code_t bmp280_read_calibration_word_unsigned(bmp280_handle_t *handle, bmp280_register_address_t startRegisterAddress, uint16_t *result);
-static bmp280_error_code_t bmp280_read_calibration_word_signed(bmp280_handle_t *handle, bmp280_register_address_t startRegisterAddress, int16_t *result);
+/*Burst reads consecutive registers*/
+static bmp280_error_code_t bmp280_read_registers(bmp280_handle_t *handle, bmp280_register_address_t registerAddress, uint8_t *data, uint8_t length);
+/*Turns the three bytes of a pressure or temperature reading into a 20 bit value*/
+static int32_t bmp280_raw_20bit(const uint8_t *raw);
+static void bmp280_decode_calibration(const uint8_t *data, bmp280_calibration_param_t *dig);
+#if BMP280_INCLUDE_WARM_START
+static uint32_t bmp280_calibration_hash(const bmp280_calibration_param_t *dig);
+#endif
+/*Turns an osrs field into an oversampling value; 5, 6 and 7 all mean 16x*/
+static bmp280_over_sampling_t bmp280_decode_oversampling(uint8_t field);
+/*Turns ctrl_meas and config into settings*/
+static void bmp280_decode_settings(uint8_t ctrl_meas, uint8_t config, bmp280_settings_t *settings);
+/*Number of samples of an oversampling setting*/
+static uint32_t bmp280_oversampling_factor(bmp280_over_sampling_t osValue);
+/*Waits for the end of a conversion. Waits*/
+static bmp280_error_code_t bmp280_wait_for_measurement(bmp280_handle_t *handle);
+/*Time of the clock dependency, 0 without one*/
+static uint32_t bmp280_now_us(bmp280_handle_t *handle);
+/*Waits until a duration has passed since a time of bmp280_now_us(). Waits*/
+static bmp280_error_code_t bmp280_delay_until(bmp280_handle_t *handle, uint32_t start_us, uint32_t duration_us);
+/*Sleeps with the microsecond delay function, or the millisecond one rounded up. Waits*/
+static bmp280_error_code_t bmp280_sleep_us(bmp280_handle_t *handle, uint32_t delay_us);
+/*The wait policy spins, and there is a clock to spin on*/
+static uint8_t bmp280_spinning(bmp280_handle_t *handle);
+#if BMP280_INCLUDE_ADDITIONAL_GETTERS
+/*Time from the start of a conversion to the point the wait policy waits for*/
+static uint32_t bmp280_conversion_time_us(bmp280_handle_t *handle, const bmp280_timing_t *timing);
+/*Waits for a conversion as the wait policy says. Waits*/
+static bmp280_error_code_t bmp280_wait_for_conversion(bmp280_handle_t *handle, uint32_t start_us, uint32_t duration_us);
+#endif
+#if BMP280_INCLUDE_ADDITIONAL_GETTERS
+/*Reads and compensates the data registers of a finished conversion, optionally starting the next forced conversion in between*/
+static bmp280_error_code_t bmp280_read_sample(bmp280_handle_t *handle, bmp280_sensors_data_t *data, uint8_t start_next);
+/*Length of the data read of the next sample, and the bytes that are not read*/
+static uint8_t bmp280_prepare_sample(bmp280_handle_t *handle, uint8_t *raw);
+/*Compensates the sample and keeps track of the temperature decimation*/
+static bmp280_error_code_t bmp280_finish_sample(bmp280_handle_t *handle, const uint8_t *raw, uint8_t length, bmp280_sensors_data_t *data);
+#if BMP280_INCLUDE_ASYNC
+/*Submits the transfer or timer of a step of an asynchronous operation*/
+static bmp280_error_code_t bmp280_async_submit(bmp280_async_operation_t *operation, bmp280_async_step_t step, uint32_t delay_us);
+/*Completion of every transfer and timer of an asynchronous operation: runs the next step*/
+static void bmp280_async_continue(void *context, int result);
+/*Updates the handle after a completed step, with the exclusion hook held, and picks the next step*/
+static bmp280_error_code_t bmp280_async_advance(bmp280_async_operation_t *operation, int result, bmp280_async_step_t *next, uint32_t *delay_us);
+/*Ends the asynchronous operation of the handle*/
+static bmp280_error_code_t bmp280_async_release(bmp280_handle_t *handle);
+#endif
+#endif
+#if BMP280_INCLUDE_ADDITIONAL_GETTERS || BMP280_INCLUDE_SCHEDULER
+/*Turns 6 bytes of raw pressure and temperature into sensor data, reusing the last result for a repeated sample*/
+static bmp280_error_code_t bmp280_compensate_raw_data(bmp280_handle_t *handle, const uint8_t *raw, bmp280_sensors_data_t *data);
+#endif
+/*Integer compensation of the datasheet*/
+static int32_t bmp280_compensate_t_fine(const bmp280_calibration_param_t *dig, int32_t adc_T);
+static uint32_t bmp280_compensate_pressure(const bmp280_calibration_param_t *dig, int32_t adc_P, int32_t t_fine);
+#if BMP280_INCLUDE_SCHEDULER
+/*Moves the scheduler's period estimate by a step*/
+static void bmp280_scheduler_adjust_period(bmp280_scheduler_t *scheduler, int32_t step_us);
+#endif
+#if BMP280_INCLUDE_HEALTH_MONITOR
+#if BMP280_INCLUDE_ADDITIONAL_GETTERS || BMP280_INCLUDE_SCHEDULER
+/*Checks a compensated sample, and ctrl_meas/config if they were read with it*/
+static bmp280_error_code_t bmp280_health_check_sample(bmp280_handle_t *handle, const uint8_t *raw, const uint8_t *control, bmp280_sensors_data_t *data);
+/*The sample moved further than a slew limit from a pressure and temperature*/
+static uint8_t bmp280_health_exceeds_slew(const bmp280_health_settings_t *settings, uint32_t pressure, float temperature, const bmp280_sensors_data_t *data);
+#endif
+/*Compares ctrl_meas/config with the copies in the handle and restores them*/
+static bmp280_error_code_t bmp280_health_check_registers(bmp280_handle_t *handle, const uint8_t *control);
+/*Reads ctrl_meas/config if a check of them is due*/
+static bmp280_error_code_t bmp280_health_read_registers(bmp280_handle_t *handle);
+#endif
+/*Writes ctrl_meas and config again from the copies in the handle*/
+static bmp280_error_code_t bmp280_restore_registers(bmp280_handle_t *handle);
+#if BMP280_INCLUDE_ADDITIONAL_GETTERS
+/*Starts a forced mode conversion and waits for it. Waits*/
+static bmp280_error_code_t bmp280_trigger_forced_measurement(bmp280_handle_t *handle);
+/*Starts a forced mode conversion and returns its timing, without waiting*/
+static bmp280_error_code_t bmp280_start_forced_measurement(bmp280_handle_t *handle, bmp280_timing_t *timing);
+#endif
 
 
 bmp280_error_code_t bmp280_init(
@@ -84,158 +205,173 @@ bmp280_error_code_t bmp280_init(
 {
 	bmp280_error_code_t error;
 
-	/*check for NULL handle*/
-	if(handle == NULL)
-	{
-		return BMP280_ERROR_NULL_HANDLE;
-	}
-
-	#if BMP280_INCLUDE_EXCLUSION_HOOK
-	if(handle->dependency_interface.bmp280_interface_exclusion.mutex_handle == NULL)
-	{
-		return BMP280_ERROR_NULL_MUTEX_HANDLE;
-	}
-	#endif
+	error = bmp280_check_dependencies(handle);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
 
-	/*check for NULL or undefined dependencies*/
-	if(handle->dependency_interface.bmp280_delay_function == NULL ||
-		handle->dependency_interface.bmp280_interface_init == NULL ||
-		handle->dependency_interface.bmp280_interface_deinit == NULL ||
+	BMP280_LOCK(handle);
+	error = bmp280_start_interface(handle, hw_interface, i2c_address);
+	BMP280_UNLOCK(handle);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
 
-		#if BMP280_INCLUDE_ALTITUDE
-		handle->dependency_interface.bmp280_power_function == NULL ||
-		#endif
+	return bmp280_cold_start(handle);
+}
 
-		#if BMP280_INCLUDE_EXCLUSION_HOOK
-		handle->dependency_interface.bmp280_interface_exclusion.bmp280_interface_lock == NULL ||
-		handle->dependency_interface.bmp280_interface_exclusion.bmp280_interface_unlock == NULL ||
-		#endif
+/*initializes several sensors at once: the reset of every sensor shares a single startup delay.
+a sensor that fails a step is left out of the later ones, and the others go on*/
+bmp280_error_code_t bmp280_init_multiple(
+	bmp280_handle_t *handles[],
+	bmp280_hardware_interface_t hw_interface,
+	const bmp280_i2c_address_t i2c_addresses[],
+	uint8_t count,
+	bmp280_error_code_t errors[])
+{
+	bmp280_error_code_t result = BMP280_ERROR_OK;
+	bmp280_handle_t *started = NULL;
+	uint8_t index;
 
-		handle->dependency_interface.bmp280_read_array == NULL ||
-		handle->dependency_interface.bmp280_write_array == NULL)
+	if(handles == NULL || i2c_addresses == NULL || errors == NULL || count == 0)
 	{
-		return BMP280_ERROR_NULL_INTERFACE;
+		return BMP280_ERROR_NULL_HANDLE;
 	}
 
-	handle->hardware_interface = hw_interface;
-
-	/*check if the hardware interface is set to I2C*/
-	if(hw_interface == BMP280_I2C)
-	{
-		handle->i2c_address = i2c_address;
-	}
-	else
+	/*the sensors may share one mutex, so each handle is locked on its own and never two at a time*/
+	for(index = 0; index < count; index++)
 	{
-		handle->i2c_address = BMP280_I2C_ADDRESS_NONE;
+		errors[index] = bmp280_start_and_reset(handles[index], hw_interface, i2c_addresses[index]);
+		if (errors[index] == BMP280_ERROR_OK && started == NULL)
+		{
+			started = handles[index];
+		}
 	}
 
-	/*initialize the hardware interface*/
-	BMP280_LOCK(handle);
-	if(handle->dependency_interface.bmp280_interface_init((uint8_t)(handle->i2c_address)) != 0)
+	/*from the last reset; the earlier sensors have been starting up since theirs*/
+	if (started != NULL)
 	{
-		BMP280_UNLOCK(handle);
-		return BMP280_ERROR_INTERFACE_INIT;
+		bmp280_error_code_t error = bmp280_delay_until(started, bmp280_now_us(started), (uint32_t)BMP280_STARTUP_DELAY_IN_MS * 1000);
+
+		for(index = 0; index < count && error != BMP280_ERROR_OK; index++)
+		{
+			errors[index] = (errors[index] == BMP280_ERROR_OK) ? error : errors[index];
+		}
 	}
-	BMP280_UNLOCK(handle);
 
-	/*check if the driver can connect to sensor hardware by checking its ID*/
-	error = bmp280_check_id(handle);
-	
-	if(error != BMP280_ERROR_OK)
+	for(index = 0; index < count; index++)
 	{
-		handle->i2c_address = BMP280_I2C_ADDRESS_NONE;
-		return error;
-	}
+		if (errors[index] == BMP280_ERROR_OK)
+		{
+			errors[index] = bmp280_calibrate_and_configure(handles[index]);
+		}
 
-	error = bmp280_reset(handle);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
+		result = (result == BMP280_ERROR_OK) ? errors[index] : result;
+	}
 
-	error = bmp280_get_calibration(handle);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
+	return result;
+}
 
-	error = bmp280_set_mode(handle, BMP280_MODE_DEFAULT);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
+#if BMP280_INCLUDE_WARM_START
+/*adopts a running sensor if its calibration and configuration match the cache, otherwise does a full initialization*/
+bmp280_error_code_t bmp280_init_warm(
+	bmp280_handle_t *handle,
+	bmp280_hardware_interface_t hw_interface,
+	bmp280_i2c_address_t i2c_address,
+	bmp280_warm_start_cache_t *cache)
+{
+	bmp280_error_code_t error;
 
-	error = bmp280_set_pressure_oversampling(handle, BMP280_PRESSURE_OVERSAMPLING_DEFAULT);
+	error = bmp280_check_dependencies(handle);
 	BMP280_CHECK_AND_RETURN_ERROR(error);
 
-	error = bmp280_set_temperature_oversampling(handle, BMP280_TEMPERATURE_OVERSAMPLING_DEFAULT);
+	BMP280_LOCK(handle);
+	error = bmp280_start_interface(handle, hw_interface, i2c_address);
+	BMP280_UNLOCK(handle);
 	BMP280_CHECK_AND_RETURN_ERROR(error);
 
-	error = bmp280_set_standby_time(handle, BMP280_STANDBY_TIME_DEFAULT);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
+	return bmp280_adopt_or_cold_start(handle, cache);
+}
 
-	error = bmp280_set_filter_coefficient(handle, BMP280_FILTER_DEFAULT);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
+/*stores calibration and the current ctrl_meas/config for the next warm start*/
+bmp280_error_code_t bmp280_save_warm_start_cache(
+	bmp280_handle_t *handle,
+	bmp280_warm_start_cache_t *cache)
+{
+	bmp280_error_code_t error;
 
-	handle->poll_timeout_ms = BMP280_MEASURING_POLL_TIMEOUT_IN_MS;
+	BMP280_LOCK(handle);
+	error = bmp280_fill_warm_start_cache(handle, cache);
+	BMP280_UNLOCK(handle);
 
-	return BMP280_ERROR_OK;
+	return error;
 }
+#endif
 
 bmp280_error_code_t bmp280_deinit(bmp280_handle_t *handle)
 {
-	bmp280_error_code_t error = bmp280_reset(handle);
-
+	bmp280_error_code_t error = bmp280_soft_reset(handle);
 	BMP280_CHECK_AND_RETURN_ERROR(error);
 
+	#if BMP280_INCLUDE_SHARED_BUS
+	if (handle->bus != NULL)
+	{
+		return BMP280_ERROR_OK;
+	}
+	#endif
+
 	BMP280_LOCK(handle);
-	if(handle->dependency_interface.bmp280_interface_deinit((uint8_t)handle->i2c_address) != 0)
+	if (handle->dependency_interface.bmp280_interface_deinit((uint8_t)handle->i2c_address) != 0)
 	{
-		BMP280_UNLOCK(handle);
-		return BMP280_ERROR_INTERFACE_DEINIT;
+		error = BMP280_ERROR_INTERFACE_DEINIT;
 	}
 	BMP280_UNLOCK(handle);
 
-	handle->operation_mode = BMP280_MODE_SLEEP;
-
-	return BMP280_ERROR_OK;
+	return error;
 }
 
-/*checks chip id to see if it really is a bmp280 module with correct wiring and address*/
-bmp280_error_code_t bmp280_check_id(bmp280_handle_t *handle)
+/*restores ctrl_meas and config from the handle if the sensor lost them; the calibration is not read again*/
+bmp280_error_code_t bmp280_reinit(bmp280_handle_t *handle)
 {
-	uint8_t data;
+	uint8_t mode_mask;
+	uint8_t control[2];
+	bmp280_error_code_t error;
 
-	BMP280_LOCK(handle);
-	if (handle->dependency_interface.bmp280_read_array(handle->i2c_address, BMP280_REGISTER_ADDRESS_ID, &data, 1) != 0)
-	{
-		BMP280_UNLOCK(handle);
-		return BMP280_ERROR_INTERFACE_READ;
-	}
-	BMP280_UNLOCK(handle);
+	error = bmp280_check_dependencies(handle);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
+
+	/*a forced mode sensor is back in sleep mode after each conversion*/
+	mode_mask = (handle->operation_mode == BMP280_MODE_FORCED) ? 0xFC : 0xFF;
 
-	if (data == BMP280_DEFAULT_CHIP_ID)
+	BMP280_LOCK(handle);
+	error = bmp280_read_chip_id(handle);
+	if (error == BMP280_ERROR_OK)
 	{
-		return BMP280_ERROR_OK;
+		error = bmp280_read_registers(handle, BMP280_REGISTER_ADDRESS_CONTROL_MEAS, control, 2);
 	}
-	else
+	if (error == BMP280_ERROR_OK && (((control[0] ^ handle->ctrl_meas) & mode_mask) != 0 || control[1] != handle->config))
 	{
-		return BMP280_ERROR_SENSOR_ID;
+		error = bmp280_restore_registers(handle);
 	}
+	/*a forced conversion started before the failure may never have happened*/
+	handle->forced_pending = 0;
+	BMP280_UNLOCK(handle);
+
+	return error;
 }
 
-/*soft resets bm280 using special reset register*/
-bmp280_error_code_t bmp280_reset(bmp280_handle_t *handle)
+/*checks chip id to see if it really is a bmp280 module with correct wiring and address*/
+bmp280_error_code_t bmp280_check_id(bmp280_handle_t *handle)
 {
-	uint8_t data = BMP280_RESET_VALUE;
+	bmp280_error_code_t error;
 
 	BMP280_LOCK(handle);
-	if (handle->dependency_interface.bmp280_write_array((uint8_t)handle->i2c_address, BMP280_REGISTER_ADDRESS_RESET, &data, 1) != 0)
-	{
-		BMP280_UNLOCK(handle);
-		return BMP280_ERROR_INTERFACE_WRITE;
-	}
+	error = bmp280_read_chip_id(handle);
 	BMP280_UNLOCK(handle);
 
-	if (handle->dependency_interface.bmp280_delay_function(BMP280_STARTUP_DELAY_IN_MS) != 0)
-	{
-		return BMP280_ERROR_INTERFACE_DELAY;
-	}
-
-	handle->operation_mode = BMP280_MODE_SLEEP;
+	return error;
+}
 
-	return BMP280_ERROR_OK;
+/*soft resets bm280 using special reset register*/
+bmp280_error_code_t bmp280_reset(bmp280_handle_t *handle)
+{
+	return bmp280_soft_reset(handle);
 }
 
 /*setting bmp280 mode, NORMAL_MODE, FORCED_MODE, SLEEP_MODE*/
@@ -243,20 +379,7 @@ bmp280_error_code_t bmp280_set_mode(
 	bmp280_handle_t *handle,
 	bmp280_operation_mode_t operationMode)
 {
-	bmp280_error_code_t error = bmp280_set_bits_in_register(handle, BMP280_REGISTER_ADDRESS_CONTROL_MEAS, operationMode, BMP280_REGISTER_BIT_MODE, BMP280_REGISTER_FIELD_LENGTH_MODE);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
-
-	BMP280_LOCK(handle);
-	if (handle->dependency_interface.bmp280_delay_function(50) != 0)
-	{
-		BMP280_UNLOCK(handle);
-		return BMP280_ERROR_INTERFACE_DELAY;
-	}
-	BMP280_UNLOCK(handle);
-
-	handle->operation_mode = operationMode;
-
-	return BMP280_ERROR_OK;
+	return bmp280_write_mode(handle, operationMode);
 }
 
 /*setting pressure oversampling from 0 (skip) to 16x*/
@@ -264,19 +387,7 @@ bmp280_error_code_t bmp280_set_pressure_oversampling(
 	bmp280_handle_t *handle,
 	bmp280_over_sampling_t osValue)
 {
-	bmp280_operation_mode_t operation_mode = handle->operation_mode;
-
-	/*In order to change configuration, the BMP280 sensor must be in SLEEP mode*/
-	bmp280_error_code_t error = bmp280_set_mode(handle, BMP280_MODE_SLEEP);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
-
-	error = bmp280_set_bits_in_register(handle, BMP280_REGISTER_ADDRESS_CONTROL_MEAS, (uint8_t)osValue, BMP280_REGISTER_BIT_OSRS_P, BMP280_REGISTER_FIELD_LENGTH_OSRS_P);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
-
-	error = bmp280_set_mode(handle, operation_mode);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
-
-	return BMP280_ERROR_OK;
+	return bmp280_set_field_in_sleep(handle, BMP280_REGISTER_ADDRESS_CONTROL_MEAS, (uint8_t)osValue, BMP280_REGISTER_BIT_OSRS_P, BMP280_REGISTER_FIELD_LENGTH_OSRS_P);
 }
 
 /*setting temperature oversampling from 0 (skip) to 16x*/
@@ -284,18 +395,7 @@ bmp280_error_code_t bmp280_set_temperature_oversampling(
 	bmp280_handle_t *handle,
 	bmp280_over_sampling_t osValue)
 {
-	bmp280_operation_mode_t operation_mode = handle->operation_mode;
-
-	bmp280_error_code_t error = bmp280_set_mode(handle, BMP280_MODE_SLEEP);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
-
-	error = bmp280_set_bits_in_register(handle, BMP280_REGISTER_ADDRESS_CONTROL_MEAS, (uint8_t)osValue, BMP280_REGISTER_BIT_OSRS_T, BMP280_REGISTER_FIELD_LENGTH_OSRS_T);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
-
-	error = bmp280_set_mode(handle, operation_mode);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
-
-	return BMP280_ERROR_OK;
+	return bmp280_set_field_in_sleep(handle, BMP280_REGISTER_ADDRESS_CONTROL_MEAS, (uint8_t)osValue, BMP280_REGISTER_BIT_OSRS_T, BMP280_REGISTER_FIELD_LENGTH_OSRS_T);
 }
 
 /*sets standby time between measurements in normal mode. lower standby time means higher power consumption*/
@@ -303,18 +403,7 @@ bmp280_error_code_t bmp280_set_standby_time(
 	bmp280_handle_t *handle,
 	bmp280_standby_time_t standbyTime)
 {
-	bmp280_operation_mode_t operation_mode = handle->operation_mode;
-
-	bmp280_error_code_t error = bmp280_set_mode(handle, BMP280_MODE_SLEEP);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
-
-	error = bmp280_set_bits_in_register(handle, BMP280_REGISTER_ADDRESS_CONFIG, (uint8_t)standbyTime, BMP280_REGISTER_BIT_T_SB, BMP280_REGISTER_FIELD_LENGTH_T_SB);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
-
-	error = bmp280_set_mode(handle, operation_mode);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
-
-	return BMP280_ERROR_OK;
+	return bmp280_set_field_in_sleep(handle, BMP280_REGISTER_ADDRESS_CONFIG, (uint8_t)standbyTime, BMP280_REGISTER_BIT_T_SB, BMP280_REGISTER_FIELD_LENGTH_T_SB);
 }
 
 /*sets low pass internal filter coefficient for bmp280. used in noisy environments*/
@@ -322,114 +411,418 @@ bmp280_error_code_t bmp280_set_filter_coefficient(
 	bmp280_handle_t *handle,
 	bmp280_iir_filter_t filterCoefficient)
 {
-	bmp280_operation_mode_t operation_mode = handle->operation_mode;
-
-	bmp280_error_code_t error = bmp280_set_mode(handle, BMP280_MODE_SLEEP);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
+	return bmp280_set_field_in_sleep(handle, BMP280_REGISTER_ADDRESS_CONFIG, (uint8_t)filterCoefficient, BMP280_REGISTER_BIT_FILTER, BMP280_REGISTER_FIELD_LENGTH_FILTER);
+}
 
-	error = bmp280_set_bits_in_register(handle, BMP280_REGISTER_ADDRESS_CONFIG, (uint8_t)filterCoefficient, BMP280_REGISTER_BIT_FILTER, BMP280_REGISTER_FIELD_LENGTH_FILTER);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
+/*sets all measurement settings with the minimum number of writes: config is only accepted in sleep mode, ctrl_meas carries the mode*/
+bmp280_error_code_t bmp280_set_settings(
+	bmp280_handle_t *handle,
+	const bmp280_settings_t *settings)
+{
+	bmp280_error_code_t error;
 
-	error = bmp280_set_mode(handle, operation_mode);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
+	BMP280_LOCK(handle);
+	error = bmp280_write_settings(handle, settings);
+	BMP280_UNLOCK(handle);
 
-	return BMP280_ERROR_OK;
+	return error;
 }
 
-/*reads temperature value from internal bmp280 registers in centigrade*/
-bmp280_error_code_t bmp280_get_temperature(
+/*applies one of the recommended settings of the datasheet*/
+bmp280_error_code_t bmp280_set_profile(
 	bmp280_handle_t *handle,
-	float *temperature)
+	bmp280_usage_profile_t profile)
 {
-	int32_t adc_T;
+	if ((uint8_t)profile >= sizeof(BMP280_PROFILES) / sizeof(BMP280_PROFILES[0]))
+	{
+		return BMP280_ERROR_PROFILE_UNKNOWN;
+	}
 
-	bmp280_error_code_t error = bmp280_raw_temperature_data(handle, &adc_T);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
+	return bmp280_set_settings(handle, &BMP280_PROFILES[profile].settings);
+}
 
-	int32_t var1, var2;
+/*the spinning policies read the clock in a loop, so they need one*/
+bmp280_error_code_t bmp280_set_wait_policy(
+	bmp280_handle_t *handle,
+	bmp280_wait_policy_t policy,
+	uint16_t spinMarginUs)
+{
+	if (policy != BMP280_WAIT_SLEEP && policy != BMP280_WAIT_SLEEP_THEN_SPIN && policy != BMP280_WAIT_SPIN)
+	{
+		return BMP280_ERROR_WAIT_POLICY_UNKNOWN;
+	}
 
-	var1 = ((((adc_T >> 3) - ((int32_t)handle->dig.T1 << 1))) * ((int32_t)handle->dig.T2)) >> 11;
-	var2 = (((((adc_T >> 4) - ((int32_t)handle->dig.T1)) * ((adc_T >> 4) - ((int32_t)handle->dig.T1))) >> 12) * ((int32_t)handle->dig.T3)) >> 14;
+	if (policy != BMP280_WAIT_SLEEP && handle->dependency_interface.bmp280_clock_us == NULL)
+	{
+		return BMP280_ERROR_NULL_INTERFACE;
+	}
 
-	handle->t_fine = var1 + var2;
-	int32_t temp_temperature = (handle->t_fine * 5 + 128) >> 8;
-	*temperature = ((float)temp_temperature) / 100.0;
+	BMP280_LOCK(handle);
+	handle->wait_policy = policy;
+	handle->spin_margin_us = spinMarginUs;
+	BMP280_UNLOCK(handle);
 
 	return BMP280_ERROR_OK;
 }
 
-/*reads pressure value from internal bmp280 registers in pascal*/
-bmp280_error_code_t bmp280_get_pressure(
+/*timing of the configuration last written to the sensor*/
+bmp280_error_code_t bmp280_get_timing(
 	bmp280_handle_t *handle,
-	uint32_t *pressure)
+	bmp280_timing_t *timing)
 {
-	int32_t adc_P;
+	bmp280_settings_t settings;
 
-	bmp280_error_code_t error = bmp280_raw_pressure_data(handle, &adc_P);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
+	BMP280_LOCK(handle);
+	bmp280_decode_settings(handle->ctrl_meas, handle->config, &settings);
+	BMP280_UNLOCK(handle);
 
-	int32_t var1, var2;
+	return bmp280_calculate_timing(&settings, timing);
+}
+
+/*measurement time is 1 + 2 * osrs_t + (2 * osrs_p + 0.5) ms typical, 1.25 + 2.3 * osrs_t + (2.3 * osrs_p + 0.575) ms maximum*/
+bmp280_error_code_t bmp280_calculate_timing(
+	const bmp280_settings_t *settings,
+	bmp280_timing_t *timing)
+{
+	static const uint32_t standby_time_us[8] = {500, 62500, 125000, 250000, 500000, 1000000, 2000000, 4000000};
+	uint32_t temperature_samples = bmp280_oversampling_factor(settings->temperature_oversampling);
+	uint32_t pressure_samples = bmp280_oversampling_factor(settings->pressure_oversampling);
 
-	var1 = (((int32_t)handle->t_fine) / 2) - (int32_t)64000;
-	var2 = (((var1 / 4) * (var1 / 4)) / 2048) * ((int32_t)handle->dig.P6);
-	var2 = var2 + ((var1 * ((int32_t)handle->dig.P5)) * 2);
-	var2 = (var2 / 4) + (((int32_t)handle->dig.P4) * 65536);
-	var1 = (((handle->dig.P3 * (((var1 / 4) * (var1 / 4)) / 8192)) / 8) + ((((int32_t)handle->dig.P2) * var1) / 2)) / 262144;
-	var1 = ((((32768 + var1)) * ((int32_t)handle->dig.P1)) / 32768);
-	*pressure = (uint32_t)(((int32_t)(1048576 - adc_P) - (var2 / 4096)) * 3125);
+	timing->measurement_time_typical_us = 1000 + 2000 * temperature_samples + ((pressure_samples == 0) ? 0 : (2000 * pressure_samples + 500));
+	timing->measurement_time_max_us = 1250 + 2300 * temperature_samples + ((pressure_samples == 0) ? 0 : (2300 * pressure_samples + 575));
 
-	/* Avoid exception caused by division with zero */
-	if (var1 != 0)
+	if (settings->operation_mode == BMP280_MODE_NORMAL)
 	{
-		/* Check for overflows against UINT32_MAX/2; if pres is left-shifted by 1 */
-		if (*pressure < 0x80000000)
-		{
-			*pressure = (*pressure << 1) / ((uint32_t)var1);
-		}
-		else
-		{
-			*pressure = (*pressure / (uint32_t)var1) * 2;
-		}
-		var1 = (((int32_t)handle->dig.P9) * ((int32_t)(((*pressure / 8) * (*pressure / 8)) / 8192))) / 4096;
-		var2 = (((int32_t)(*pressure / 4)) * ((int32_t)handle->dig.P8)) / 8192;
-		*pressure = (uint32_t)((int32_t)*pressure + ((var1 + var2 + handle->dig.P7) / 16));
+		timing->standby_time_us = standby_time_us[(uint8_t)settings->standby_time & 0x07];
+		timing->sample_period_us = timing->measurement_time_typical_us + timing->standby_time_us;
 	}
 	else
 	{
-		*pressure = 0;
+		timing->standby_time_us = 0;
+		timing->sample_period_us = timing->measurement_time_max_us;
 	}
 
+	timing->odr_hz = 1000000.0f / (float)timing->sample_period_us;
+
 	return BMP280_ERROR_OK;
 }
 
-#if BMP280_INCLUDE_ALTITUDE
-/*calculates altitude from barometric pressure without temperature as an argument*/
-bmp280_error_code_t bmp280_calculate_altitude_quick(
+/*reads temperature value from internal bmp280 registers in centigrade*/
+bmp280_error_code_t bmp280_get_temperature(
 	bmp280_handle_t *handle,
-	float *alt,
-	uint32_t barometricPressure)
+	float *temperature)
 {
-	float temp_result;
+	uint8_t raw[3];
+	bmp280_error_code_t error;
 
-	if (handle->dependency_interface.bmp280_power_function(barometricPressure, 0.190284, &temp_result) != 0)
-	{
-		return BMP280_ERROR_INTERFACE_MATH_POW;
-	}
+	error = bmp280_wait_for_measurement(handle);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
 
-	*alt = 44307.69396 * (1 - 0.111555816 * temp_result); /*calculating altitude from barometric formula*/
+	BMP280_LOCK(handle);
+	error = bmp280_read_registers(handle, BMP280_REGISTER_ADDRESS_TEMPERATURE_MSB, raw, 3);
+	BMP280_UNLOCK(handle);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
+
+	*temperature = ((float)((bmp280_compensate_t_fine(&handle->dig, bmp280_raw_20bit(raw)) * 5 + 128) >> 8)) / 100.0;
 
 	return BMP280_ERROR_OK;
 }
 
-/*calculates altitude from barometric pressure and temperature as arguments*/
-bmp280_error_code_t bmp280_calculate_altitude_hypsometric(
+/*reads pressure value from internal bmp280 registers in pascal*/
+bmp280_error_code_t bmp280_get_pressure(
 	bmp280_handle_t *handle,
-	float *alt,
-	uint32_t barometricPressure,
-	float ambientTemperatureInC)
+	uint32_t *pressure)
 {
-	float temp_result;
-	
+	uint8_t raw[6];
+	bmp280_error_code_t error;
+
+	/*the temperature of the same conversion gives t_fine, so no state is shared with other calls*/
+	error = bmp280_wait_for_measurement(handle);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
+
+	BMP280_LOCK(handle);
+	error = bmp280_read_registers(handle, BMP280_REGISTER_ADDRESS_PRESSURE_MSB, raw, 6);
+	BMP280_UNLOCK(handle);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
+
+	*pressure = bmp280_compensate_pressure(&handle->dig, bmp280_raw_20bit(&raw[0]), bmp280_compensate_t_fine(&handle->dig, bmp280_raw_20bit(&raw[3])));
+
+	return BMP280_ERROR_OK;
+}
+
+#if BMP280_INCLUDE_SCHEDULER
+/*starts searching the conversion phase of a sensor in normal mode*/
+bmp280_error_code_t bmp280_scheduler_init(
+	bmp280_handle_t *handle,
+	bmp280_scheduler_t *scheduler,
+	uint32_t now_us)
+{
+	bmp280_timing_t timing;
+	bmp280_error_code_t error;
+
+	if (handle->operation_mode != BMP280_MODE_NORMAL)
+	{
+		return BMP280_ERROR_MODE_NOT_NORMAL;
+	}
+
+	error = bmp280_get_timing(handle, &timing);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
+
+	scheduler->nominal_period_us = timing.sample_period_us;
+	scheduler->sample_period_us = timing.sample_period_us;
+	scheduler->measurement_time_us = timing.measurement_time_typical_us;
+	scheduler->guard_us = timing.measurement_time_max_us - timing.measurement_time_typical_us;
+	scheduler->next_conversion_end_us = now_us;
+	scheduler->synced = 0;
+	scheduler->measuring_seen = 0;
+	scheduler->reads = 0;
+	scheduler->misses = 0;
+	scheduler->duplicates = 0;
+	scheduler->resyncs = 0;
+
+	return BMP280_ERROR_OK;
+}
+
+/*reads once per conversion, just after it completes. status, ctrl_meas and the data registers come in one burst*/
+bmp280_error_code_t bmp280_scheduler_get_all(
+	bmp280_handle_t *handle,
+	bmp280_scheduler_t *scheduler,
+	uint32_t now_us,
+	bmp280_sensors_data_t *data)
+{
+	uint8_t burst[10];
+	uint8_t measuring, raw_valid;
+	bmp280_error_code_t error;
+
+	/*the data registers still hold the last sample*/
+	if ((int32_t)(now_us - bmp280_scheduler_next_read_us(scheduler)) < 0)
+	{
+		BMP280_LOCK(handle);
+		*data = handle->last_data;
+		BMP280_UNLOCK(handle);
+
+		data->new_data = 0;
+		scheduler->duplicates++;
+		return BMP280_ERROR_OK;
+	}
+
+	BMP280_LOCK(handle);
+	raw_valid = handle->last_raw_valid;
+	error = bmp280_read_registers(handle, BMP280_REGISTER_ADDRESS_STATUS, burst, 10);
+	if (error == BMP280_ERROR_OK)
+	{
+		/*pressure and temperature follow status, ctrl_meas, config and a reserved byte*/
+		error = bmp280_compensate_raw_data(handle, &burst[4], data);
+	}
+	#if BMP280_INCLUDE_HEALTH_MONITOR
+	/*ctrl_meas and config came with the burst: the health monitor compares them on every read, so a sensor that fell back to sleep mode is restored*/
+	if (error == BMP280_ERROR_OK)
+	{
+		error = bmp280_health_check_sample(handle, &burst[4], &burst[1], data);
+	}
+	#endif
+	if (error == BMP280_ERROR_OK && (burst[1] & 0x03) != BMP280_MODE_NORMAL)
+	{
+		error = BMP280_ERROR_MODE_NOT_NORMAL;
+	}
+	BMP280_UNLOCK(handle);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
+
+	scheduler->reads++;
+	measuring = (burst[0] >> BMP280_REGISTER_BIT_MEASURING) & 0x01;
+
+	if (scheduler->synced)
+	{
+		uint32_t late_us = now_us - scheduler->next_conversion_end_us;
+		uint32_t phase_us = late_us % scheduler->sample_period_us;
+		uint32_t standby_us = scheduler->nominal_period_us - scheduler->measurement_time_us;
+
+		/*no new sample, or a conversion running where a standby was certain (the phase is known to half a measurement): the phase drifted*/
+		if (!data->new_data || (measuring && phase_us + scheduler->measurement_time_us / 2 < standby_us))
+		{
+			/*the sensor's oscillator is slower or faster than nominal: nudge the period towards it*/
+			if (!data->new_data)
+			{
+				bmp280_scheduler_adjust_period(scheduler, (int32_t)(scheduler->sample_period_us >> 8));
+			}
+			else
+			{
+				bmp280_scheduler_adjust_period(scheduler, -(int32_t)(scheduler->sample_period_us >> 8));
+			}
+
+			scheduler->synced = 0;
+			scheduler->measuring_seen = measuring;
+			scheduler->next_conversion_end_us = now_us + scheduler->measurement_time_us / 2;
+			scheduler->resyncs++;
+		}
+		else
+		{
+			/*every whole period of delay overwrote a sample*/
+			scheduler->misses += late_us / scheduler->sample_period_us;
+			scheduler->next_conversion_end_us += (late_us / scheduler->sample_period_us + 1) * scheduler->sample_period_us;
+
+			/*a faster sensor would leave the reads behind without a sign on the bus, so the period leans short until a read comes early*/
+			bmp280_scheduler_adjust_period(scheduler, -(int32_t)((scheduler->sample_period_us >> 14) + 1));
+		}
+	}
+	else if ((raw_valid && data->new_data) || (scheduler->measuring_seen && !measuring))
+	{
+		/*a conversion completed since the last poll; reading late against it is safe, reading early is not*/
+		scheduler->synced = 1;
+		scheduler->measuring_seen = 0;
+		scheduler->next_conversion_end_us = now_us + scheduler->sample_period_us;
+	}
+	else
+	{
+		/*searching the end of a conversion: it shows as the measuring bit falling or as new data*/
+		scheduler->measuring_seen = measuring;
+		scheduler->next_conversion_end_us = now_us + scheduler->measurement_time_us / 2;
+	}
+
+	if (!data->new_data)
+	{
+		scheduler->duplicates++;
+	}
+
+	return BMP280_ERROR_OK;
+}
+
+/*follows the sensor's oscillator, within an eighth of the nominal period*/
+static void bmp280_scheduler_adjust_period(bmp280_scheduler_t *scheduler, int32_t step_us)
+{
+	uint32_t period_us = (uint32_t)((int32_t)scheduler->sample_period_us + step_us);
+	uint32_t margin_us = scheduler->nominal_period_us >> 3;
+
+	if (period_us < scheduler->nominal_period_us - margin_us)
+	{
+		period_us = scheduler->nominal_period_us - margin_us;
+	}
+	else if (period_us > scheduler->nominal_period_us + margin_us)
+	{
+		period_us = scheduler->nominal_period_us + margin_us;
+	}
+
+	scheduler->sample_period_us = period_us;
+}
+
+/*just after the expected end of the next conversion, or the next poll while searching*/
+uint32_t bmp280_scheduler_next_read_us(const bmp280_scheduler_t *scheduler)
+{
+	return scheduler->synced ? (scheduler->next_conversion_end_us + scheduler->guard_us) : scheduler->next_conversion_end_us;
+}
+#endif
+
+#if BMP280_INCLUDE_HEALTH_MONITOR
+/*NULL settings turn the monitor off. the counters and the reference sample start over*/
+bmp280_error_code_t bmp280_set_health_monitor(
+	bmp280_handle_t *handle,
+	const bmp280_health_settings_t *settings)
+{
+	bmp280_health_monitor_t monitor = {0};
+
+	if (settings != NULL)
+	{
+		monitor.enabled = 1;
+		monitor.settings = *settings;
+		monitor.samples_to_check = settings->register_check_interval;
+	}
+
+	BMP280_LOCK(handle);
+	handle->health = monitor;
+	BMP280_UNLOCK(handle);
+
+	return BMP280_ERROR_OK;
+}
+
+bmp280_error_code_t bmp280_get_health(
+	bmp280_handle_t *handle,
+	bmp280_health_status_t *status)
+{
+	BMP280_LOCK(handle);
+	*status = handle->health.status;
+	BMP280_UNLOCK(handle);
+
+	return BMP280_ERROR_OK;
+}
+
+/*the recovery steps a sample read cannot take: a due ctrl_meas/config check (after an asynchronous read), then a due reset*/
+bmp280_error_code_t bmp280_health_recover(bmp280_handle_t *handle)
+{
+	bmp280_operation_mode_t operation_mode;
+	uint8_t ctrl_meas, config, enabled, reset_pending;
+	bmp280_error_code_t error = BMP280_ERROR_OK;
+
+	/*the readers update the health fields under the hook, so they are copied with the settings*/
+	BMP280_LOCK(handle);
+	enabled = handle->health.enabled;
+	if (enabled)
+	{
+		error = bmp280_health_read_registers(handle);
+	}
+	reset_pending = handle->health.reset_pending;
+	operation_mode = handle->operation_mode;
+	ctrl_meas = handle->ctrl_meas;
+	config = handle->config;
+	BMP280_UNLOCK(handle);
+
+	/*a mismatch that was found is restored already*/
+	if (error != BMP280_ERROR_OK && error != BMP280_ERROR_SENSOR_FAULT)
+	{
+		return error;
+	}
+
+	if (!enabled || !reset_pending)
+	{
+		return BMP280_ERROR_OK;
+	}
+
+	error = bmp280_soft_reset(handle);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
+
+	/*the reset cleared the copies of ctrl_meas and config; the calibration is in the NVM and stays valid*/
+	BMP280_LOCK(handle);
+	handle->operation_mode = operation_mode;
+	handle->ctrl_meas = ctrl_meas;
+	handle->config = config;
+	error = bmp280_restore_registers(handle);
+	handle->health.reset_pending = 0;
+	handle->health.restored = 0;
+	handle->health.identical_reads = 0;
+	handle->health.status.resets++;
+	BMP280_UNLOCK(handle);
+
+	return error;
+}
+#endif
+
+#if BMP280_INCLUDE_ALTITUDE
+/*calculates altitude from barometric pressure without temperature as an argument*/
+bmp280_error_code_t bmp280_calculate_altitude_quick(
+	bmp280_handle_t *handle,
+	float *alt,
+	uint32_t barometricPressure)
+{
+	float temp_result;
+
+	if (handle->dependency_interface.bmp280_power_function(barometricPressure, 0.190284, &temp_result) != 0)
+	{
+		return BMP280_ERROR_INTERFACE_MATH_POW;
+	}
+
+	*alt = 44307.69396 * (1 - 0.111555816 * temp_result); /*calculating altitude from barometric formula*/
+
+	return BMP280_ERROR_OK;
+}
+
+/*calculates altitude from barometric pressure and temperature as arguments*/
+bmp280_error_code_t bmp280_calculate_altitude_hypsometric(
+	bmp280_handle_t *handle,
+	float *alt,
+	uint32_t barometricPressure,
+	float ambientTemperatureInC)
+{
+	float temp_result;
+	
 	if (handle->dependency_interface.bmp280_power_function((float)SEA_LEVEL_PRESSURE / (float)barometricPressure, (float)1 / 5.257, &temp_result) != 0)
 	{
 		return BMP280_ERROR_INTERFACE_MATH_POW;
@@ -451,338 +844,1785 @@ bmp280_error_code_t bmp280_get_all(
 
 	if (handle->operation_mode == BMP280_MODE_FORCED)
 	{
-		error = bmp280_set_mode(handle, BMP280_MODE_FORCED);
+		error = bmp280_trigger_forced_measurement(handle);
 		BMP280_CHECK_AND_RETURN_ERROR(error);
 	}
 
-	error = bmp280_get_temperature(handle, &data->temperature);
+	error = bmp280_wait_for_measurement(handle);
 	BMP280_CHECK_AND_RETURN_ERROR(error);
 
-	error = bmp280_get_pressure(handle, &(data->pressure));
+	/*one lock for the data read and the cached sample*/
+	BMP280_LOCK(handle);
+	error = bmp280_read_sample(handle, data, 0);
+	BMP280_UNLOCK(handle);
+
+	#if BMP280_INCLUDE_HEALTH_MONITOR
+	/*the sample is rejected either way; the reset waits, so it runs outside the lock*/
+	if (error == BMP280_ERROR_SENSOR_FAULT && handle->health.reset_pending)
+	{
+		bmp280_error_code_t recover_error = bmp280_health_recover(handle);
+		error = (recover_error != BMP280_ERROR_OK) ? recover_error : error;
+	}
+	#endif
+
+	return error;
+}
+
+/*in forced mode, the next conversion is started right after the data registers are read; the next call finds it finished*/
+bmp280_error_code_t bmp280_get_all_pipelined(
+	bmp280_handle_t *handle,
+	bmp280_sensors_data_t *data)
+{
+	bmp280_error_code_t error;
+
+	if (handle->operation_mode != BMP280_MODE_FORCED)
+	{
+		return bmp280_get_all(handle, data);
+	}
+
+	/*nothing in flight: first call, or the settings changed since the last one*/
+	if (!handle->forced_pending)
+	{
+		error = bmp280_trigger_forced_measurement(handle);
+		BMP280_CHECK_AND_RETURN_ERROR(error);
+	}
+
+	/*a single status read if the application took longer than the conversion*/
+	error = bmp280_wait_for_measurement(handle);
 	BMP280_CHECK_AND_RETURN_ERROR(error);
 
-	#if BMP280_INCLUDE_ALTITUDE
-	error = bmp280_calculate_altitude_quick(handle, &data->altitude, data->pressure);
+	BMP280_LOCK(handle);
+	error = bmp280_read_sample(handle, data, 1);
+	BMP280_UNLOCK(handle);
+
+	#if BMP280_INCLUDE_HEALTH_MONITOR
+	if (error == BMP280_ERROR_SENSOR_FAULT && handle->health.reset_pending)
+	{
+		bmp280_error_code_t recover_error = bmp280_health_recover(handle);
+		error = (recover_error != BMP280_ERROR_OK) ? recover_error : error;
+	}
+	#endif
+
+	return error;
+}
+
+/*the conversions of all forced mode sensors run at the same time: one wait for the slowest instead of one per sensor*/
+bmp280_error_code_t bmp280_get_all_multiple(
+	bmp280_handle_t *handles[],
+	bmp280_sensors_data_t data[],
+	uint8_t count)
+{
+	uint32_t longest_measurement_us = 0;
+	uint32_t first_trigger_us;
+	bmp280_error_code_t error;
+	bmp280_error_code_t result = BMP280_ERROR_OK;
+	uint8_t index;
+
+	if (handles == NULL || data == NULL || count == 0)
+	{
+		return BMP280_ERROR_NULL_HANDLE;
+	}
+
+	for (index = 0; index < count; index++)
+	{
+		if (handles[index] == NULL)
+		{
+			return BMP280_ERROR_NULL_HANDLE;
+		}
+
+		/*the single wait runs on the clock and wait policy of the first handle*/
+		if (handles[index]->dependency_interface.bmp280_clock_us != handles[0]->dependency_interface.bmp280_clock_us ||
+			handles[index]->wait_policy != handles[0]->wait_policy ||
+			handles[index]->spin_margin_us != handles[0]->spin_margin_us)
+		{
+			return BMP280_ERROR_WAIT_MISMATCH;
+		}
+	}
+
+	/*trigger all; with a clock, the end of each conversion is counted from the first trigger*/
+	first_trigger_us = bmp280_now_us(handles[0]);
+	for (index = 0; index < count; index++)
+	{
+		bmp280_timing_t timing;
+		uint32_t measurement_us;
+
+		if (handles[index]->operation_mode != BMP280_MODE_FORCED)
+		{
+			continue;
+		}
+
+		error = bmp280_start_forced_measurement(handles[index], &timing);
+		BMP280_CHECK_AND_RETURN_ERROR(error);
+		measurement_us = bmp280_conversion_time_us(handles[0], &timing) + (bmp280_now_us(handles[0]) - first_trigger_us);
+
+		if (measurement_us > longest_measurement_us)
+		{
+			longest_measurement_us = measurement_us;
+		}
+	}
+
+	/*wait once*/
+	error = bmp280_wait_for_conversion(handles[0], first_trigger_us, longest_measurement_us);
 	BMP280_CHECK_AND_RETURN_ERROR(error);
+
+	/*read all; the measuring bit is normally clear by now, so each wait is a single status read*/
+	for (index = 0; index < count; index++)
+	{
+		error = bmp280_wait_for_measurement(handles[index]);
+		BMP280_CHECK_AND_RETURN_ERROR(error);
+
+		BMP280_LOCK(handles[index]);
+		error = bmp280_read_sample(handles[index], &data[index], 0);
+		BMP280_UNLOCK(handles[index]);
+
+		#if BMP280_INCLUDE_HEALTH_MONITOR
+		/*a rejected sample does not stop the frame; a due reset runs as in bmp280_get_all()*/
+		if (error == BMP280_ERROR_SENSOR_FAULT)
+		{
+			result = error;
+			error = handles[index]->health.reset_pending ? bmp280_health_recover(handles[index]) : BMP280_ERROR_OK;
+		}
+		#endif
+		BMP280_CHECK_AND_RETURN_ERROR(error);
+	}
+
+	return result;
+}
+
+#if BMP280_INCLUDE_SHARED_BUS
+/*normal mode data registers always hold a complete sample, so all devices are read back to back in one lock hold*/
+bmp280_error_code_t bmp280_bus_get_all(
+	bmp280_bus_t *bus,
+	bmp280_handle_t *handles[],
+	bmp280_sensors_data_t data[],
+	uint8_t count)
+{
+	bmp280_error_code_t error = BMP280_ERROR_OK;
+	uint8_t index;
+
+	if (bus == NULL || handles == NULL || data == NULL || count == 0)
+	{
+		return BMP280_ERROR_NULL_HANDLE;
+	}
+
+	for (index = 0; index < count; index++)
+	{
+		if (handles[index] == NULL || handles[index]->bus != bus)
+		{
+			return BMP280_ERROR_BUS_MISMATCH;
+		}
+
+		if (handles[index]->operation_mode != BMP280_MODE_NORMAL)
+		{
+			return BMP280_ERROR_MODE_NOT_NORMAL;
+		}
+	}
+
+	BMP280_LOCK(handles[0]);
+	for (index = 0; index < count && error == BMP280_ERROR_OK; index++)
+	{
+		error = bmp280_read_sample(handles[index], &data[index], 0);
+	}
+	BMP280_UNLOCK(handles[0]);
+
+	#if BMP280_INCLUDE_HEALTH_MONITOR
+	/*the reset waits, so it runs after the lock is released*/
+	if (error == BMP280_ERROR_SENSOR_FAULT && handles[index - 1]->health.reset_pending)
+	{
+		bmp280_error_code_t recover_error = bmp280_health_recover(handles[index - 1]);
+		error = (recover_error != BMP280_ERROR_OK) ? recover_error : error;
+	}
 	#endif
-	
+
+	return error;
+}
+#endif
+
+#if BMP280_INCLUDE_ASYNC
+/*starts the first step; the others run in the completions of the transport*/
+bmp280_error_code_t bmp280_get_all_async(
+	bmp280_handle_t *handle,
+	bmp280_async_operation_t *operation,
+	bmp280_sensors_data_t *data,
+	bmp280_async_done_fp done,
+	void *context)
+{
+	if (handle == NULL || operation == NULL || data == NULL || done == NULL)
+	{
+		return BMP280_ERROR_NULL_HANDLE;
+	}
+
+	if (handle->dependency_interface.bmp280_async_read == NULL ||
+		handle->dependency_interface.bmp280_async_write == NULL ||
+		handle->dependency_interface.bmp280_async_timer == NULL)
+	{
+		return BMP280_ERROR_NULL_INTERFACE;
+	}
+
+	bmp280_async_step_t step = BMP280_ASYNC_STATUS;
+	bmp280_error_code_t error;
+	uint8_t busy;
+
+	if (operation->step != BMP280_ASYNC_IDLE)
+	{
+		return BMP280_ERROR_ASYNC_BUSY;
+	}
+
+	/*one operation per handle: a second one would interleave its forced trigger and data read with the first*/
+	BMP280_LOCK(handle);
+	busy = handle->async_busy;
+	if (!busy)
+	{
+		handle->async_busy = 1;
+
+		if (handle->operation_mode == BMP280_MODE_FORCED)
+		{
+			operation->buffer[0] = (uint8_t)((handle->ctrl_meas & ~0x03) | BMP280_MODE_FORCED);
+			step = BMP280_ASYNC_TRIGGER;
+		}
+	}
+	#if BMP280_INCLUDE_EXCLUSION_HOOK
+	if (bmp280_exclusion_unlock(handle) != 0)
+	{
+		/*no operation starts, so the flag set above must not stay*/
+		if (!busy)
+		{
+			handle->async_busy = 0;
+		}
+		return BMP280_ERROR_EXCLUSION_UNLOCK;
+	}
+	#endif
+
+	if (busy)
+	{
+		return BMP280_ERROR_ASYNC_BUSY;
+	}
+
+	operation->handle = handle;
+	operation->data = data;
+	operation->done = done;
+	operation->context = context;
+	operation->slept_us = 0;
+	operation->start_us = bmp280_now_us(handle);
+
+	/*the hook is released before the submission: a transport may complete in place, and the completion takes the hook*/
+	error = bmp280_async_submit(operation, step, 0);
+	if (error != BMP280_ERROR_OK)
+	{
+		bmp280_error_code_t release_error = bmp280_async_release(handle);
+		error = (release_error != BMP280_ERROR_OK) ? release_error : error;
+	}
+
+	return error;
+}
+#endif
+
+/*reads temperature only every interval samples, or sooner if it drifts*/
+bmp280_error_code_t bmp280_set_temperature_decimation(
+	bmp280_handle_t *handle,
+	uint8_t interval,
+	uint16_t driftLimit)
+{
+	BMP280_LOCK(handle);
+	handle->temperature_interval = interval;
+	handle->temperature_drift_limit = driftLimit;
+	handle->temperature_countdown = 0;
+	BMP280_UNLOCK(handle);
+
+	return BMP280_ERROR_OK;
+}
+
+/*returns bmp280 mode of operation: sleep, normal or forced*/
+bmp280_error_code_t bmp280_get_mode(
+	bmp280_handle_t *handle,
+	bmp280_operation_mode_t *mode)
+{
+	uint8_t readMode;
+	bmp280_error_code_t error;
+
+	BMP280_LOCK(handle);
+	error = bmp280_get_bits_in_register(handle, BMP280_REGISTER_ADDRESS_CONTROL_MEAS, &readMode, BMP280_REGISTER_BIT_MODE, BMP280_REGISTER_FIELD_LENGTH_MODE);
+	BMP280_UNLOCK(handle);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
+
+	switch (readMode)
+	{
+	case 0X00:
+		*mode = BMP280_MODE_SLEEP;
+		break;
+	case 0X01:
+		*mode = BMP280_MODE_FORCED;
+		break;
+	case 0X02:
+		*mode = BMP280_MODE_FORCED;
+		break;
+	case 0X03:
+		*mode = BMP280_MODE_NORMAL;
+		break;
+	default:
+		return BMP280_ERROR_MODE_UNKNOWN;
+	}
+
+	return BMP280_ERROR_OK;
+}
+
+/*returns the current temperature oversampling*/
+bmp280_error_code_t bmp280_get_temperature_oversampling(
+	bmp280_handle_t *handle,
+	bmp280_over_sampling_t *tempOS)
+{
+	uint8_t readOS;
+	bmp280_error_code_t error;
+
+	BMP280_LOCK(handle);
+	error = bmp280_get_bits_in_register(handle, BMP280_REGISTER_ADDRESS_CONTROL_MEAS, &readOS, BMP280_REGISTER_BIT_OSRS_T, BMP280_REGISTER_FIELD_LENGTH_OSRS_T);
+	BMP280_UNLOCK(handle);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
+
+	if (readOS > BMP280_OVERSAMPLING_16X)
+	{
+		*tempOS = BMP280_OVERSAMPLING_16X;
+	}
+	else
+	{
+		*tempOS = (bmp280_over_sampling_t)readOS;
+	}
+
+	return BMP280_ERROR_OK;
+}
+
+/*returns the current pressure oversampling*/
+bmp280_error_code_t bmp280_get_pressure_oversampling(
+	bmp280_handle_t *handle,
+	bmp280_over_sampling_t *pressureOS)
+{
+	uint8_t readOS;
+	bmp280_error_code_t error;
+
+	BMP280_LOCK(handle);
+	error = bmp280_get_bits_in_register(handle, BMP280_REGISTER_ADDRESS_CONTROL_MEAS, &readOS, BMP280_REGISTER_BIT_OSRS_P, BMP280_REGISTER_FIELD_LENGTH_OSRS_P);
+	BMP280_UNLOCK(handle);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
+
+	if (readOS > BMP280_OVERSAMPLING_16X)
+	{
+		*pressureOS = BMP280_OVERSAMPLING_16X;
+	}
+	else
+	{
+		*pressureOS = (bmp280_over_sampling_t)readOS;
+	}
+
+	return BMP280_ERROR_OK;
+}
+
+/*returns the current standby time (for normal mode)*/
+bmp280_error_code_t bmp280_get_standby_time(
+	bmp280_handle_t *handle,
+	bmp280_standby_time_t *standby_time)
+{
+	uint8_t readTime;
+	bmp280_error_code_t error;
+
+	BMP280_LOCK(handle);
+	error = bmp280_get_bits_in_register(handle, BMP280_REGISTER_ADDRESS_CONFIG, &readTime, BMP280_REGISTER_BIT_T_SB, BMP280_REGISTER_FIELD_LENGTH_T_SB);
+	BMP280_UNLOCK(handle);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
+
+	*standby_time = (bmp280_standby_time_t)readTime;
+
+	return BMP280_ERROR_OK;
+}
+
+/*returns the current IIR filter coefficient*/
+bmp280_error_code_t bmp280_get_filter_coefficient(
+	bmp280_handle_t *handle,
+	bmp280_iir_filter_t *filter_coeff)
+{
+	uint8_t readFilter;
+	bmp280_error_code_t error;
+
+	BMP280_LOCK(handle);
+	error = bmp280_get_bits_in_register(handle, BMP280_REGISTER_ADDRESS_CONFIG, &readFilter, BMP280_REGISTER_BIT_FILTER, BMP280_REGISTER_FIELD_LENGTH_FILTER);
+	BMP280_UNLOCK(handle);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
+
+	if(readFilter > (int) BMP280_FILTER_16X)
+	{
+		return BMP280_ERROR_FILTER_COEFF_UNKNOWN;
+	}
+
+	*filter_coeff = (bmp280_iir_filter_t)readFilter;
+
+	return BMP280_ERROR_OK;
+}
+
+/*returns all measurement settings, from ctrl_meas and config in one burst read*/
+bmp280_error_code_t bmp280_get_settings(
+	bmp280_handle_t *handle,
+	bmp280_settings_t *settings)
+{
+	uint8_t control[2];
+
+	bmp280_error_code_t error;
+
+	BMP280_LOCK(handle);
+	error = bmp280_read_registers(handle, BMP280_REGISTER_ADDRESS_CONTROL_MEAS, control, 2);
+	BMP280_UNLOCK(handle);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
+
+	if (((control[1] >> BMP280_REGISTER_BIT_FILTER) & 0x07) > (uint8_t)BMP280_FILTER_16X)
+	{
+		return BMP280_ERROR_FILTER_COEFF_UNKNOWN;
+	}
+
+	bmp280_decode_settings(control[0], control[1], settings);
+
+	return BMP280_ERROR_OK;
+}
+
+#endif
+
+/*fine resolution temperature, input of the pressure compensation*/
+static int32_t bmp280_compensate_t_fine(const bmp280_calibration_param_t *dig, int32_t adc_T)
+{
+	int32_t var1, var2;
+
+	var1 = ((((adc_T >> 3) - ((int32_t)dig->T1 << 1))) * ((int32_t)dig->T2)) >> 11;
+	var2 = (((((adc_T >> 4) - ((int32_t)dig->T1)) * ((adc_T >> 4) - ((int32_t)dig->T1))) >> 12) * ((int32_t)dig->T3)) >> 14;
+
+	return var1 + var2;
+}
+
+/*pressure in pascal, 0 for an invalid calibration*/
+static uint32_t bmp280_compensate_pressure(const bmp280_calibration_param_t *dig, int32_t adc_P, int32_t t_fine)
+{
+	int32_t var1, var2;
+	uint32_t pressure;
+
+	var1 = (((int32_t)t_fine) / 2) - (int32_t)64000;
+	var2 = (((var1 / 4) * (var1 / 4)) / 2048) * ((int32_t)dig->P6);
+	var2 = var2 + ((var1 * ((int32_t)dig->P5)) * 2);
+	var2 = (var2 / 4) + (((int32_t)dig->P4) * 65536);
+	var1 = (((dig->P3 * (((var1 / 4) * (var1 / 4)) / 8192)) / 8) + ((((int32_t)dig->P2) * var1) / 2)) / 262144;
+	var1 = ((((32768 + var1)) * ((int32_t)dig->P1)) / 32768);
+	pressure = (uint32_t)(((int32_t)(1048576 - adc_P) - (var2 / 4096)) * 3125);
+
+	/* Avoid exception caused by division with zero */
+	if (var1 == 0)
+	{
+		return 0;
+	}
+
+	/* Check for overflows against UINT32_MAX/2; if pres is left-shifted by 1 */
+	if (pressure < 0x80000000)
+	{
+		pressure = (pressure << 1) / ((uint32_t)var1);
+	}
+	else
+	{
+		pressure = (pressure / (uint32_t)var1) * 2;
+	}
+	var1 = (((int32_t)dig->P9) * ((int32_t)(((pressure / 8) * (pressure / 8)) / 8192))) / 4096;
+	var2 = (((int32_t)(pressure / 4)) * ((int32_t)dig->P8)) / 8192;
+
+	return (uint32_t)((int32_t)pressure + ((var1 + var2 + dig->P7) / 16));
+}
+
+#if BMP280_INCLUDE_ADDITIONAL_GETTERS
+/*a forced conversion is done within its maximum measurement time, so it is waited for once instead of polled; the spinning wait policies stop at the typical time and poll from there*/
+static bmp280_error_code_t bmp280_trigger_forced_measurement(bmp280_handle_t *handle)
+{
+	bmp280_timing_t timing;
+	bmp280_error_code_t error = bmp280_start_forced_measurement(handle, &timing);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
+
+	/*the conversion started before the ctrl_meas write returned*/
+	return bmp280_wait_for_conversion(handle, bmp280_now_us(handle), bmp280_conversion_time_us(handle, &timing));
+}
+
+static bmp280_error_code_t bmp280_start_forced_measurement(bmp280_handle_t *handle, bmp280_timing_t *timing)
+{
+	bmp280_settings_t settings;
+	bmp280_error_code_t error;
+
+	BMP280_LOCK(handle);
+	error = bmp280_set_bits_in_register(handle, BMP280_REGISTER_ADDRESS_CONTROL_MEAS, BMP280_MODE_FORCED, BMP280_REGISTER_BIT_MODE, BMP280_REGISTER_FIELD_LENGTH_MODE);
+	handle->operation_mode = BMP280_MODE_FORCED;
+	bmp280_decode_settings(handle->ctrl_meas, handle->config, &settings);
+	BMP280_UNLOCK(handle);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
+
+	return bmp280_calculate_timing(&settings, timing);
+}
+#endif
+
+/*oversampling field of ctrl_meas; values above 16x also mean 16x*/
+static bmp280_over_sampling_t bmp280_decode_oversampling(uint8_t field)
+{
+	if (field > BMP280_OVERSAMPLING_16X)
+	{
+		return BMP280_OVERSAMPLING_16X;
+	}
+
+	return (bmp280_over_sampling_t)field;
+}
+
+/*splits ctrl_meas and config into their fields*/
+static void bmp280_decode_settings(uint8_t ctrl_meas, uint8_t config, bmp280_settings_t *settings)
+{
+	uint8_t mode = ctrl_meas & 0x03;
+
+	settings->operation_mode = (mode == 0x00) ? BMP280_MODE_SLEEP : ((mode == 0x03) ? BMP280_MODE_NORMAL : BMP280_MODE_FORCED);
+	settings->temperature_oversampling = bmp280_decode_oversampling((ctrl_meas >> BMP280_REGISTER_BIT_OSRS_T) & 0x07);
+	settings->pressure_oversampling = bmp280_decode_oversampling((ctrl_meas >> BMP280_REGISTER_BIT_OSRS_P) & 0x07);
+	settings->standby_time = (bmp280_standby_time_t)((config >> BMP280_REGISTER_BIT_T_SB) & 0x07);
+	settings->filter_coefficient = (bmp280_iir_filter_t)((config >> BMP280_REGISTER_BIT_FILTER) & 0x07);
+}
+
+/*0 (skipped), 1, 2, 4, 8 or 16 samples*/
+static uint32_t bmp280_oversampling_factor(bmp280_over_sampling_t osValue)
+{
+	return (osValue == BMP280_OVERSAMPLING_0X) ? 0 : (1UL << ((uint32_t)osValue - 1));
+}
+
+/*polls the measuring bit until the data registers hold a complete conversion, with a timeout*/
+static bmp280_error_code_t bmp280_wait_for_measurement(bmp280_handle_t *handle)
+{
+	const uint32_t poll_period_us = (uint32_t)BMP280_MEASURING_POLL_PERIOD_IN_MS * 1000;
+	uint32_t start_us = bmp280_now_us(handle);
+	uint32_t slept_us = 0;
+
+	/*Polling and waiting for new data with a timeout*/
+	for( uint8_t measuring_status = BMP280_MEASURING_IN_PROGRESS; measuring_status == BMP280_MEASURING_IN_PROGRESS; )
+	{
+		bmp280_error_code_t error;
+
+		/*only the status read holds the hook; other devices use the bus while this one waits*/
+		BMP280_LOCK(handle);
+		error = bmp280_get_bits_in_register(handle, BMP280_REGISTER_ADDRESS_STATUS, &measuring_status, BMP280_REGISTER_BIT_MEASURING, BMP280_REGISTER_FIELD_LENGTH_MEASURING);
+		BMP280_UNLOCK(handle);
+		BMP280_CHECK_AND_RETURN_ERROR(error);
+
+		if(measuring_status == BMP280_MEASURING_IN_PROGRESS)
+		{
+			/*with a clock, bus time and oversleeping count too*/
+			uint32_t waited_us = (handle->dependency_interface.bmp280_clock_us != NULL) ? bmp280_now_us(handle) - start_us : slept_us;
+
+			if(waited_us + (bmp280_spinning(handle) ? 0 : poll_period_us) > BMP280_MEASURING_POLL_TIMEOUT_IN_US)
+			{
+				return BMP280_ERROR_SENSOR_POLL_TIMEOUT;
+			}
+
+			slept_us += poll_period_us;
+
+			/*the spinning policies read the status again right away*/
+			if(!bmp280_spinning(handle))
+			{
+				error = bmp280_sleep_us(handle, poll_period_us);
+				BMP280_CHECK_AND_RETURN_ERROR(error);
+			}
+		}
+	}
+
+	return BMP280_ERROR_OK;
+}
+
+static uint32_t bmp280_now_us(bmp280_handle_t *handle)
+{
+	return (handle->dependency_interface.bmp280_clock_us != NULL) ? handle->dependency_interface.bmp280_clock_us() : 0;
+}
+
+/*a deadline instead of a fixed delay: the time already spent since start_us is not waited again. without a clock, the whole duration is waited*/
+static bmp280_error_code_t bmp280_delay_until(bmp280_handle_t *handle, uint32_t start_us, uint32_t duration_us)
+{
+	uint32_t elapsed_us = bmp280_now_us(handle) - start_us;
+
+	if (elapsed_us >= duration_us)
+	{
+		return BMP280_ERROR_OK;
+	}
+
+	return bmp280_sleep_us(handle, duration_us - elapsed_us);
+}
+
+static bmp280_error_code_t bmp280_sleep_us(bmp280_handle_t *handle, uint32_t delay_us)
+{
+	if (handle->dependency_interface.bmp280_delay_us_function != NULL)
+	{
+		return (handle->dependency_interface.bmp280_delay_us_function(delay_us) != 0) ? BMP280_ERROR_INTERFACE_DELAY : BMP280_ERROR_OK;
+	}
+
+	if (handle->dependency_interface.bmp280_delay_function((delay_us + 999) / 1000) != 0)
+	{
+		return BMP280_ERROR_INTERFACE_DELAY;
+	}
+
+	return BMP280_ERROR_OK;
+}
+
+/*without a clock (e.g. removed after the policy was set) every policy sleeps*/
+static uint8_t bmp280_spinning(bmp280_handle_t *handle)
+{
+	return (handle->wait_policy != BMP280_WAIT_SLEEP && handle->dependency_interface.bmp280_clock_us != NULL);
+}
+
+#if BMP280_INCLUDE_ADDITIONAL_GETTERS
+/*sleeping has to cover the worst case; spinning ends at the typical time and polls the rest*/
+static uint32_t bmp280_conversion_time_us(bmp280_handle_t *handle, const bmp280_timing_t *timing)
+{
+	return bmp280_spinning(handle) ? timing->measurement_time_typical_us : timing->measurement_time_max_us;
+}
+
+static bmp280_error_code_t bmp280_wait_for_conversion(bmp280_handle_t *handle, uint32_t start_us, uint32_t duration_us)
+{
+	if (!bmp280_spinning(handle))
+	{
+		return bmp280_delay_until(handle, start_us, duration_us);
+	}
+
+	/*sleep through all but the spin margin; the delay function may oversleep by up to that much*/
+	if (handle->wait_policy == BMP280_WAIT_SLEEP_THEN_SPIN && duration_us > handle->spin_margin_us)
+	{
+		bmp280_error_code_t error = bmp280_delay_until(handle, start_us, duration_us - handle->spin_margin_us);
+		BMP280_CHECK_AND_RETURN_ERROR(error);
+	}
+
+	while ((uint32_t)(bmp280_now_us(handle) - start_us) < duration_us)
+	{
+	}
+
+	return BMP280_ERROR_OK;
+}
+#endif
+
+#if BMP280_INCLUDE_ADDITIONAL_GETTERS || BMP280_INCLUDE_SCHEDULER
+/*compensates a raw pressure and temperature block, unless it is the one compensated last time*/
+static bmp280_error_code_t bmp280_compensate_raw_data(bmp280_handle_t *handle, const uint8_t *raw, bmp280_sensors_data_t *data)
+{
+	uint8_t unchanged = handle->last_raw_valid;
+	int32_t t_fine;
+
+	for (uint8_t index = 0; index < 6; index++)
+	{
+		if (raw[index] != handle->last_raw[index])
+		{
+			unchanged = 0;
+		}
+	}
+
+	/*in forced mode every read follows its own conversion, so only normal mode can repeat a sample*/
+	if (unchanged)
+	{
+		*data = handle->last_data;
+		data->new_data = (handle->operation_mode != BMP280_MODE_NORMAL);
+		return BMP280_ERROR_OK;
+	}
+
+	t_fine = bmp280_compensate_t_fine(&handle->dig, bmp280_raw_20bit(&raw[3]));
+	data->temperature = ((float)((t_fine * 5 + 128) >> 8)) / 100.0;
+	data->pressure = bmp280_compensate_pressure(&handle->dig, bmp280_raw_20bit(&raw[0]), t_fine);
+
+	#if BMP280_INCLUDE_ALTITUDE
+	bmp280_error_code_t error = bmp280_calculate_altitude_quick(handle, &data->altitude, data->pressure);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
+	#endif
+
+	data->new_data = 1;
+
+	for (uint8_t index = 0; index < 6; index++)
+	{
+		handle->last_raw[index] = raw[index];
+	}
+	handle->last_raw_valid = 1;
+	handle->last_data = *data;
+
+	return BMP280_ERROR_OK;
+}
+#endif
+
+#if BMP280_INCLUDE_HEALTH_MONITOR
+#if BMP280_INCLUDE_ADDITIONAL_GETTERS || BMP280_INCLUDE_SCHEDULER
+/*runs on the registers the read transferred anyway. ctrl_meas and config are compared if they came with it; otherwise a fault makes a read of them due*/
+static bmp280_error_code_t bmp280_health_check_sample(
+	bmp280_handle_t *handle,
+	const uint8_t *raw,
+	const uint8_t *control,
+	bmp280_sensors_data_t *data)
+{
+	bmp280_health_monitor_t *monitor = &handle->health;
+	bmp280_fault_t fault = BMP280_FAULT_NONE;
+	uint8_t pressure_skipped = ((handle->ctrl_meas >> BMP280_REGISTER_BIT_OSRS_P) & 0x07) == 0;
+	uint8_t temperature_skipped = ((handle->ctrl_meas >> BMP280_REGISTER_BIT_OSRS_T) & 0x07) == 0;
+
+	if (!monitor->enabled)
+	{
+		return BMP280_ERROR_OK;
+	}
+
+	/*0x80000 is the reset value of the data registers; it is only expected from a skipped measurement*/
+	if ((!pressure_skipped && bmp280_raw_20bit(&raw[0]) == 0x80000) || (!temperature_skipped && bmp280_raw_20bit(&raw[3]) == 0x80000))
+	{
+		fault = BMP280_FAULT_SKIPPED;
+		monitor->status.skipped++;
+	}
+	else if (data->new_data || handle->operation_mode != BMP280_MODE_NORMAL)
+	{
+		monitor->identical_reads = 0;
+	}
+	else if (monitor->settings.stuck_limit != 0)
+	{
+		/*a normal mode sensor updates its data registers every sample period; reads in between find them unchanged*/
+		if (monitor->identical_reads < UINT16_MAX)
+		{
+			monitor->identical_reads++;
+		}
+		if (monitor->identical_reads >= monitor->settings.stuck_limit)
+		{
+			fault = BMP280_FAULT_STUCK;
+		}
+		if (monitor->identical_reads == monitor->settings.stuck_limit)
+		{
+			monitor->status.stuck++;
+		}
+	}
+
+	if (fault == BMP280_FAULT_NONE && data->new_data)
+	{
+		/*a step is real if the next sample stays at it; a spike is rejected alone*/
+		if (monitor->reference_valid &&
+			bmp280_health_exceeds_slew(&monitor->settings, monitor->reference_pressure, monitor->reference_temperature, data) &&
+			!(monitor->suspect_valid && !bmp280_health_exceeds_slew(&monitor->settings, monitor->suspect_pressure, monitor->suspect_temperature, data)))
+		{
+			fault = BMP280_FAULT_SLEW;
+			monitor->status.slew_faults++;
+			monitor->suspect_pressure = data->pressure;
+			monitor->suspect_temperature = data->temperature;
+			monitor->suspect_valid = 1;
+			monitor->sample_rejected = 1;
+		}
+		else
+		{
+			monitor->reference_pressure = data->pressure;
+			monitor->reference_temperature = data->temperature;
+			monitor->reference_valid = 1;
+			monitor->suspect_valid = 0;
+			monitor->sample_rejected = 0;
+			monitor->restored = 0;
+		}
+	}
+	else if (fault == BMP280_FAULT_NONE && monitor->sample_rejected)
+	{
+		/*a repeated read of the rejected sample*/
+		fault = BMP280_FAULT_SLEW;
+	}
+
+	if (fault != BMP280_FAULT_NONE)
+	{
+		monitor->status.last_fault = fault;
+	}
+
+	/*a run of identical reads asks once, at the stuck limit*/
+	if (fault == BMP280_FAULT_SKIPPED || (fault == BMP280_FAULT_STUCK && monitor->identical_reads == monitor->settings.stuck_limit))
+	{
+		monitor->check_due = 1;
+		monitor->check_reason = fault;
+	}
+	else if (monitor->settings.register_check_interval != 0 && data->new_data && monitor->samples_to_check > 0 && --monitor->samples_to_check == 0)
+	{
+		monitor->check_due = 1;
+	}
+
+	if (control != NULL)
+	{
+		bmp280_error_code_t error = bmp280_health_check_registers(handle, control);
+		BMP280_CHECK_AND_RETURN_ERROR(error);
+	}
+
+	return (fault != BMP280_FAULT_NONE) ? BMP280_ERROR_SENSOR_FAULT : BMP280_ERROR_OK;
+}
+
+static uint8_t bmp280_health_exceeds_slew(
+	const bmp280_health_settings_t *settings,
+	uint32_t pressure,
+	float temperature,
+	const bmp280_sensors_data_t *data)
+{
+	uint32_t pressure_change = (data->pressure > pressure) ? data->pressure - pressure : pressure - data->pressure;
+	float temperature_change = (data->temperature > temperature) ? data->temperature - temperature : temperature - data->temperature;
+
+	return (settings->pressure_slew_limit != 0 && pressure_change > settings->pressure_slew_limit) ||
+		(settings->temperature_slew_limit != 0 && temperature_change * 100 > settings->temperature_slew_limit);
+}
+#endif
+
+/*a mismatch is written back once; a fault with matching registers, or one that the write back did not cure, makes a reset due*/
+static bmp280_error_code_t bmp280_health_check_registers(bmp280_handle_t *handle, const uint8_t *control)
+{
+	bmp280_health_monitor_t *monitor = &handle->health;
+	/*a forced mode sensor is back in sleep mode after each conversion*/
+	uint8_t mode_mask = (handle->operation_mode == BMP280_MODE_FORCED) ? 0xFC : 0xFF;
+	bmp280_fault_t reason = monitor->check_reason;
+	bmp280_error_code_t error = BMP280_ERROR_OK;
+
+	monitor->check_due = 0;
+	monitor->check_reason = BMP280_FAULT_NONE;
+	monitor->samples_to_check = monitor->settings.register_check_interval;
+
+	if (((control[0] ^ handle->ctrl_meas) & mode_mask) == 0 && control[1] == handle->config)
+	{
+		/*set up as written, yet no valid data: only a reset is left*/
+		if (reason != BMP280_FAULT_NONE && monitor->settings.auto_recover)
+		{
+			monitor->reset_pending = 1;
+		}
+
+		return BMP280_ERROR_OK;
+	}
+
+	monitor->status.register_faults++;
+	monitor->status.last_fault = BMP280_FAULT_REGISTERS;
+
+	if (monitor->settings.auto_recover && monitor->restored)
+	{
+		monitor->reset_pending = 1;
+	}
+	else if (monitor->settings.auto_recover)
+	{
+		error = bmp280_restore_registers(handle);
+		monitor->status.restores++;
+		monitor->restored = 1;
+		monitor->identical_reads = 0;
+	}
+	BMP280_CHECK_AND_RETURN_ERROR(error);
+
+	return BMP280_ERROR_SENSOR_FAULT;
+}
+
+static bmp280_error_code_t bmp280_health_read_registers(bmp280_handle_t *handle)
+{
+	uint8_t control[2];
+	bmp280_error_code_t error;
+
+	if (!handle->health.check_due)
+	{
+		return BMP280_ERROR_OK;
+	}
+
+	error = bmp280_read_registers(handle, BMP280_REGISTER_ADDRESS_CONTROL_MEAS, control, 2);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
+
+	return bmp280_health_check_registers(handle, control);
+}
+#endif
+
+#if BMP280_INCLUDE_ADDITIONAL_GETTERS
+/*between temperature reads, only the pressure bytes are read; the temperature bytes of the last read stand in*/
+static uint8_t bmp280_prepare_sample(bmp280_handle_t *handle, uint8_t *raw)
+{
+	for (uint8_t index = 3; index < 6; index++)
+	{
+		raw[index] = handle->last_raw[index];
+	}
+
+	return (handle->temperature_countdown == 0 || !handle->last_raw_valid) ? 6 : 3;
+}
+
+/*compensates a sample read as bmp280_prepare_sample() said, and schedules the next temperature read*/
+static bmp280_error_code_t bmp280_finish_sample(bmp280_handle_t *handle, const uint8_t *raw, uint8_t length, bmp280_sensors_data_t *data)
+{
+	int32_t last_t_fine = bmp280_compensate_t_fine(&handle->dig, bmp280_raw_20bit(&handle->last_raw[3]));
+	uint8_t had_temperature = handle->last_raw_valid;
+	bmp280_error_code_t error;
+
+	if (length < 6)
+	{
+		handle->temperature_countdown--;
+
+		return bmp280_compensate_raw_data(handle, raw, data);
+	}
+
+	error = bmp280_compensate_raw_data(handle, raw, data);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
+
+	/*t_fine is 256 / 5 per 0.01 Centigrade*/
+	int32_t drift = bmp280_compensate_t_fine(&handle->dig, bmp280_raw_20bit(&raw[3])) - last_t_fine;
+
+	if (had_temperature && ((drift < 0) ? -drift : drift) * 5 > (int32_t)handle->temperature_drift_limit * 256)
+	{
+		handle->temperature_countdown = 0;
+	}
+	else
+	{
+		handle->temperature_countdown = (handle->temperature_interval > 1) ? (uint8_t)(handle->temperature_interval - 1) : 0;
+	}
+
+	return BMP280_ERROR_OK;
+}
+
+/*pressure and (unless decimated) temperature in one burst*/
+static bmp280_error_code_t bmp280_read_sample(bmp280_handle_t *handle, bmp280_sensors_data_t *data, uint8_t start_next)
+{
+	uint8_t raw[6];
+	uint8_t length = bmp280_prepare_sample(handle, raw);
+	bmp280_error_code_t error = bmp280_read_registers(handle, BMP280_REGISTER_ADDRESS_PRESSURE_MSB, raw, length);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
+
+	/*the data registers are copied, so the sensor converts the next sample while this one is compensated; ctrl_meas comes from the shadow copy, no read back*/
+	if (start_next)
+	{
+		error = bmp280_write_register(handle, BMP280_REGISTER_ADDRESS_CONTROL_MEAS, (uint8_t)((handle->ctrl_meas & ~0x03) | BMP280_MODE_FORCED));
+		BMP280_CHECK_AND_RETURN_ERROR(error);
+		handle->forced_pending = 1;
+	}
+
+	error = bmp280_finish_sample(handle, raw, length, data);
+
+	#if BMP280_INCLUDE_HEALTH_MONITOR
+	if (error == BMP280_ERROR_OK)
+	{
+		error = bmp280_health_check_sample(handle, raw, NULL, data);
+	}
+	if (error == BMP280_ERROR_OK || error == BMP280_ERROR_SENSOR_FAULT)
+	{
+		/*after a fault, or every register_check_interval samples*/
+		bmp280_error_code_t check_error = bmp280_health_read_registers(handle);
+		error = (check_error != BMP280_ERROR_OK) ? check_error : error;
+	}
+	#endif
+
+	return error;
+}
+
+#if BMP280_INCLUDE_ASYNC
+/*the step is set before the submission, as the completion may run before the submit function returns*/
+static bmp280_error_code_t bmp280_async_submit(bmp280_async_operation_t *operation, bmp280_async_step_t step, uint32_t delay_us)
+{
+	bmp280_dependency_t *dependency = &operation->handle->dependency_interface;
+	uint8_t address = (uint8_t)operation->handle->i2c_address;
+
+	operation->step = step;
+
+	switch (step)
+	{
+	case BMP280_ASYNC_TRIGGER:
+		if (dependency->bmp280_async_write(address, BMP280_REGISTER_ADDRESS_CONTROL_MEAS, operation->buffer, 1, bmp280_async_continue, operation) == 0)
+		{
+			return BMP280_ERROR_OK;
+		}
+		operation->step = BMP280_ASYNC_IDLE;
+		return BMP280_ERROR_INTERFACE_WRITE;
+
+	case BMP280_ASYNC_CONVERSION:
+		if (dependency->bmp280_async_timer(delay_us, bmp280_async_continue, operation) == 0)
+		{
+			return BMP280_ERROR_OK;
+		}
+		operation->step = BMP280_ASYNC_IDLE;
+		return BMP280_ERROR_INTERFACE_DELAY;
+
+	case BMP280_ASYNC_STATUS:
+		if (dependency->bmp280_async_read(address, BMP280_REGISTER_ADDRESS_STATUS, operation->buffer, 1, bmp280_async_continue, operation) == 0)
+		{
+			return BMP280_ERROR_OK;
+		}
+		operation->step = BMP280_ASYNC_IDLE;
+		return BMP280_ERROR_INTERFACE_READ;
+
+	default:
+		if (dependency->bmp280_async_read(address, BMP280_REGISTER_ADDRESS_PRESSURE_MSB, operation->buffer, operation->length, bmp280_async_continue, operation) == 0)
+		{
+			return BMP280_ERROR_OK;
+		}
+		operation->step = BMP280_ASYNC_IDLE;
+		return BMP280_ERROR_INTERFACE_READ;
+	}
+}
+
+/*the same steps as bmp280_get_all(), one per completion. once the next step is submitted, the operation may already be finished and reused: nothing is touched after a successful submission*/
+static void bmp280_async_continue(void *context, int result)
+{
+	bmp280_async_operation_t *operation = (bmp280_async_operation_t *)context;
+	bmp280_handle_t *handle = operation->handle;
+	bmp280_async_step_t next;
+	uint32_t delay_us;
+	bmp280_error_code_t error, release_error;
+
+	if (operation->step == BMP280_ASYNC_IDLE)
+	{
+		return;
+	}
+
+	error = bmp280_async_advance(operation, result, &next, &delay_us);
+
+	if (error == BMP280_ERROR_OK && next != BMP280_ASYNC_IDLE)
+	{
+		error = bmp280_async_submit(operation, next, delay_us);
+		if (error == BMP280_ERROR_OK)
+		{
+			return;
+		}
+	}
+
+	/*every path that ends the operation comes here, also a failed hook*/
+	release_error = bmp280_async_release(handle);
+	error = (error == BMP280_ERROR_OK) ? release_error : error;
+
+	operation->step = BMP280_ASYNC_IDLE;
+	operation->done(operation->context, error);
+}
+
+/*the hook covers the handle and the statistics of its bus, as for the synchronous reads, but not the submission of the next step.
+BMP280_ASYNC_IDLE as the next step ends the operation; the busy flag stays set until bmp280_async_release()*/
+static bmp280_error_code_t bmp280_async_advance(
+	bmp280_async_operation_t *operation,
+	int result,
+	bmp280_async_step_t *next,
+	uint32_t *delay_us)
+{
+	bmp280_handle_t *handle = operation->handle;
+	bmp280_error_code_t error = BMP280_ERROR_OK;
+
+	*next = BMP280_ASYNC_IDLE;
+	*delay_us = 0;
+
+	BMP280_LOCK(handle);
+
+	#if BMP280_INCLUDE_SHARED_BUS
+	/*the asynchronous transport moved the bytes; the bus counts them as its own transfers*/
+	if (handle->bus != NULL && operation->step != BMP280_ASYNC_CONVERSION)
+	{
+		uint8_t length = (operation->step == BMP280_ASYNC_DATA) ? operation->length : 1;
+
+		bmp280_bus_count_transfer(handle->bus, (uint8_t)handle->i2c_address, length, operation->step == BMP280_ASYNC_TRIGGER, result);
+	}
+	#endif
+
+	switch (operation->step)
+	{
+	case BMP280_ASYNC_TRIGGER:
+		if (result != 0)
+		{
+			error = BMP280_ERROR_INTERFACE_WRITE;
+		}
+		else
+		{
+			bmp280_settings_t settings;
+			bmp280_timing_t timing;
+
+			bmp280_update_shadow_register(handle, BMP280_REGISTER_ADDRESS_CONTROL_MEAS, operation->buffer[0]);
+			bmp280_decode_settings(handle->ctrl_meas, handle->config, &settings);
+			bmp280_calculate_timing(&settings, &timing);
+			*next = BMP280_ASYNC_CONVERSION;
+			*delay_us = timing.measurement_time_max_us;
+		}
+		break;
+
+	case BMP280_ASYNC_CONVERSION:
+		if (result != 0)
+		{
+			error = BMP280_ERROR_INTERFACE_DELAY;
+		}
+		else
+		{
+			if (operation->slept_us == 0)
+			{
+				operation->start_us = bmp280_now_us(handle);
+			}
+			*next = BMP280_ASYNC_STATUS;
+		}
+		break;
+
+	case BMP280_ASYNC_STATUS:
+		if (result != 0)
+		{
+			error = BMP280_ERROR_INTERFACE_READ;
+		}
+		else if (((operation->buffer[0] >> BMP280_REGISTER_BIT_MEASURING) & 0x01) == BMP280_MEASURING_IN_PROGRESS)
+		{
+			/*the same timeout as bmp280_wait_for_measurement()*/
+			const uint32_t poll_period_us = (uint32_t)BMP280_MEASURING_POLL_PERIOD_IN_MS * 1000;
+			uint32_t waited_us = (handle->dependency_interface.bmp280_clock_us != NULL) ? bmp280_now_us(handle) - operation->start_us : operation->slept_us;
+
+			if (waited_us + poll_period_us > BMP280_MEASURING_POLL_TIMEOUT_IN_US)
+			{
+				error = BMP280_ERROR_SENSOR_POLL_TIMEOUT;
+			}
+			else
+			{
+				operation->slept_us += poll_period_us;
+				*next = BMP280_ASYNC_CONVERSION;
+				*delay_us = poll_period_us;
+			}
+		}
+		else
+		{
+			operation->length = bmp280_prepare_sample(handle, operation->buffer);
+			*next = BMP280_ASYNC_DATA;
+		}
+		break;
+
+	default:
+		error = (result != 0) ? BMP280_ERROR_INTERFACE_READ : bmp280_finish_sample(handle, operation->buffer, operation->length, operation->data);
+		#if BMP280_INCLUDE_HEALTH_MONITOR
+		/*a ctrl_meas/config read made due here is left to the next synchronous read or bmp280_health_recover()*/
+		if (error == BMP280_ERROR_OK)
+		{
+			error = bmp280_health_check_sample(handle, operation->buffer, NULL, operation->data);
+		}
+		#endif
+		break;
+	}
+
+	BMP280_UNLOCK(handle);
+
+	return error;
+}
+
+/*the flag is cleared even if the hook fails, or the handle could never start another operation*/
+static bmp280_error_code_t bmp280_async_release(bmp280_handle_t *handle)
+{
+	#if BMP280_INCLUDE_EXCLUSION_HOOK
+	if (bmp280_exclusion_lock(handle) != 0)
+	{
+		handle->async_busy = 0;
+		return BMP280_ERROR_EXCLUSION_LOCK;
+	}
+	#endif
+
+	handle->async_busy = 0;
+	BMP280_UNLOCK(handle);
+
+	return BMP280_ERROR_OK;
+}
+#endif
+#endif
+
+/*checks for NULL handle and NULL or undefined dependencies*/
+static bmp280_error_code_t bmp280_check_dependencies(bmp280_handle_t *handle)
+{
+	/*check for NULL handle*/
+	if(handle == NULL)
+	{
+		return BMP280_ERROR_NULL_HANDLE;
+	}
+
+	if(handle->dependency_interface.bmp280_delay_function == NULL
+
+		#if BMP280_INCLUDE_ALTITUDE
+		|| handle->dependency_interface.bmp280_power_function == NULL
+		#endif
+		)
+	{
+		return BMP280_ERROR_NULL_INTERFACE;
+	}
+
+	#if BMP280_INCLUDE_SHARED_BUS
+	/*transport and lock come from the bus*/
+	if(handle->bus != NULL)
+	{
+		#if BMP280_INCLUDE_EXCLUSION_HOOK
+		if(handle->bus->bmp280_bus_exclusion.mutex_handle == NULL)
+		{
+			return BMP280_ERROR_NULL_MUTEX_HANDLE;
+		}
+
+		if(handle->bus->bmp280_bus_exclusion.bmp280_interface_lock == NULL ||
+			handle->bus->bmp280_bus_exclusion.bmp280_interface_unlock == NULL)
+		{
+			return BMP280_ERROR_NULL_INTERFACE;
+		}
+		#endif
+
+		if(handle->bus->bmp280_bus_read == NULL || handle->bus->bmp280_bus_write == NULL)
+		{
+			return BMP280_ERROR_NULL_INTERFACE;
+		}
+
+		return BMP280_ERROR_OK;
+	}
+	#endif
+
+	#if BMP280_INCLUDE_EXCLUSION_HOOK
+	if(handle->dependency_interface.bmp280_interface_exclusion.mutex_handle == NULL)
+	{
+		return BMP280_ERROR_NULL_MUTEX_HANDLE;
+	}
+	#endif
+
+	/*check for NULL or undefined dependencies*/
+	if(handle->dependency_interface.bmp280_interface_init == NULL ||
+		handle->dependency_interface.bmp280_interface_deinit == NULL ||
+
+		#if BMP280_INCLUDE_EXCLUSION_HOOK
+		handle->dependency_interface.bmp280_interface_exclusion.bmp280_interface_lock == NULL ||
+		handle->dependency_interface.bmp280_interface_exclusion.bmp280_interface_unlock == NULL ||
+		#endif
+
+		handle->dependency_interface.bmp280_read_array == NULL ||
+		handle->dependency_interface.bmp280_write_array == NULL)
+	{
+		return BMP280_ERROR_NULL_INTERFACE;
+	}
+
+	return BMP280_ERROR_OK;
+}
+
+#if BMP280_INCLUDE_EXCLUSION_HOOK
+/*handles on a shared bus use the bus lock, so every device of the bus is covered by one mutex*/
+static int bmp280_exclusion_lock(bmp280_handle_t *handle)
+{
+	#if BMP280_INCLUDE_SHARED_BUS
+	if(handle->bus != NULL)
+	{
+		if(handle->bus->bmp280_bus_exclusion.bmp280_interface_lock(handle->bus->bmp280_bus_exclusion.mutex_handle) != 0)
+		{
+			return 1;
+		}
+
+		handle->bus->statistics.lock_holds++;
+		return 0;
+	}
+	#endif
+
+	return handle->dependency_interface.bmp280_interface_exclusion.bmp280_interface_lock(handle->dependency_interface.bmp280_interface_exclusion.mutex_handle);
+}
+
+static int bmp280_exclusion_unlock(bmp280_handle_t *handle)
+{
+	#if BMP280_INCLUDE_SHARED_BUS
+	if(handle->bus != NULL)
+	{
+		return handle->bus->bmp280_bus_exclusion.bmp280_interface_unlock(handle->bus->bmp280_bus_exclusion.mutex_handle);
+	}
+	#endif
+
+	return handle->dependency_interface.bmp280_interface_exclusion.bmp280_interface_unlock(handle->dependency_interface.bmp280_interface_exclusion.mutex_handle);
+}
+#endif
+
+#if BMP280_INCLUDE_SHARED_BUS
+/*called with the bus lock held. after an error the transport may have lost the device, so the next transfer counts as a switch*/
+static bmp280_error_code_t bmp280_bus_transfer(
+	bmp280_bus_t *bus,
+	uint8_t deviceAddress,
+	uint8_t registerAddress,
+	uint8_t *data,
+	uint8_t length,
+	uint8_t write)
+{
+	int result;
+
+	if (write)
+	{
+		result = bus->bmp280_bus_write(bus->context, deviceAddress, registerAddress, data, length);
+	}
+	else
+	{
+		result = bus->bmp280_bus_read(bus->context, deviceAddress, registerAddress, data, length);
+	}
+
+	bmp280_bus_count_transfer(bus, deviceAddress, length, write, result);
+
+	if (result != 0)
+	{
+		return write ? BMP280_ERROR_INTERFACE_WRITE : BMP280_ERROR_INTERFACE_READ;
+	}
+
+	return BMP280_ERROR_OK;
+}
+
+/*called with the bus lock held, also for the transfers of the asynchronous transport*/
+static void bmp280_bus_count_transfer(
+	bmp280_bus_t *bus,
+	uint8_t deviceAddress,
+	uint8_t length,
+	uint8_t write,
+	int result)
+{
+	if (bus->current_address != deviceAddress)
+	{
+		bus->statistics.address_switches++;
+		bus->current_address = deviceAddress;
+	}
+
+	if (write)
+	{
+		bus->statistics.writes++;
+		bus->statistics.bytes_written += length;
+	}
+	else
+	{
+		bus->statistics.reads++;
+		bus->statistics.bytes_read += length;
+	}
+
+	if (result != 0)
+	{
+		bus->statistics.errors++;
+		bus->current_address = 0;
+	}
+}
+#endif
+
+static bmp280_error_code_t bmp280_start_and_reset(
+	bmp280_handle_t *handle,
+	bmp280_hardware_interface_t hw_interface,
+	bmp280_i2c_address_t i2c_address)
+{
+	bmp280_error_code_t error;
+
+	error = bmp280_check_dependencies(handle);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
+
+	BMP280_LOCK(handle);
+	error = bmp280_start_interface(handle, hw_interface, i2c_address);
+	if (error == BMP280_ERROR_OK)
+	{
+		error = bmp280_write_register(handle, BMP280_REGISTER_ADDRESS_RESET, BMP280_RESET_VALUE);
+		handle->operation_mode = BMP280_MODE_SLEEP;
+	}
+	BMP280_UNLOCK(handle);
+
+	return error;
+}
+
+static bmp280_error_code_t bmp280_calibrate_and_configure(bmp280_handle_t *handle)
+{
+	bmp280_error_code_t error;
+
+	BMP280_LOCK(handle);
+	error = bmp280_get_calibration(handle);
+	if (error == BMP280_ERROR_OK)
+	{
+		error = bmp280_write_default_configuration(handle);
+	}
+	BMP280_UNLOCK(handle);
+
+	return error;
+}
+
+/*initializes the hardware interface and checks if the driver can connect to the sensor*/
+static bmp280_error_code_t bmp280_start_interface(
+	bmp280_handle_t *handle,
+	bmp280_hardware_interface_t hw_interface,
+	bmp280_i2c_address_t i2c_address)
+{
+	bmp280_error_code_t error;
+
+	handle->hardware_interface = hw_interface;
+	handle->last_raw_valid = 0;
+	handle->forced_pending = 0;
+	#if BMP280_INCLUDE_ASYNC
+	handle->async_busy = 0;
+	#endif
+	handle->wait_policy = BMP280_WAIT_SLEEP;
+	handle->spin_margin_us = 0;
+	handle->temperature_interval = 1;
+	handle->temperature_countdown = 0;
+	handle->temperature_drift_limit = 0;
+	#if BMP280_INCLUDE_HEALTH_MONITOR
+	handle->health.enabled = 0;
+	#endif
+
+	/*check if the hardware interface is set to I2C*/
+	if(hw_interface == BMP280_I2C)
+	{
+		handle->i2c_address = i2c_address;
+	}
+	else
+	{
+		handle->i2c_address = BMP280_I2C_ADDRESS_NONE;
+	}
+
+	/*initialize the hardware interface; the transport of a shared bus is opened by its owner*/
+	#if BMP280_INCLUDE_SHARED_BUS
+	if(handle->bus == NULL && handle->dependency_interface.bmp280_interface_init((uint8_t)(handle->i2c_address)) != 0)
+	#else
+	if(handle->dependency_interface.bmp280_interface_init((uint8_t)(handle->i2c_address)) != 0)
+	#endif
+	{
+		return BMP280_ERROR_INTERFACE_INIT;
+	}
+
+	/*check if the driver can connect to sensor hardware by checking its ID*/
+	error = bmp280_read_chip_id(handle);
+	
+	if(error != BMP280_ERROR_OK)
+	{
+		handle->i2c_address = BMP280_I2C_ADDRESS_NONE;
+		return error;
+	}
+
 	return BMP280_ERROR_OK;
 }
 
-/*returns bmp280 mode of operation: sleep, normal or forced*/
-bmp280_error_code_t bmp280_get_mode(
-	bmp280_handle_t *handle,
-	bmp280_operation_mode_t *mode)
+/*resets and initializes sensor, gets the calibration data and sets the default values*/
+static bmp280_error_code_t bmp280_cold_start(bmp280_handle_t *handle)
 {
-	uint8_t readMode;
-	bmp280_error_code_t error;
-
-	error = bmp280_get_bits_in_register(handle, BMP280_REGISTER_ADDRESS_CONTROL_MEAS, &readMode, BMP280_REGISTER_BIT_MODE, BMP280_REGISTER_FIELD_LENGTH_MODE);
+	bmp280_error_code_t error = bmp280_soft_reset(handle);
 	BMP280_CHECK_AND_RETURN_ERROR(error);
 
-	switch (readMode)
+	BMP280_LOCK(handle);
+	error = bmp280_get_calibration(handle);
+	if (error == BMP280_ERROR_OK)
 	{
-	case 0X00:
-		*mode = BMP280_MODE_SLEEP;
-		break;
-	case 0X01:
-		*mode = BMP280_MODE_FORCED;
-		break;
-	case 0X02:
-		*mode = BMP280_MODE_FORCED;
-		break;
-	case 0X03:
-		*mode = BMP280_MODE_NORMAL;
-		break;
-	default:
-		return BMP280_ERROR_MODE_UNKNOWN;
+		error = bmp280_write_default_configuration(handle);
 	}
+	BMP280_UNLOCK(handle);
 
-	return BMP280_ERROR_OK;
+	return error;
 }
 
-/*returns the current temperature oversampling*/
-bmp280_error_code_t bmp280_get_temperature_oversampling(
+#if BMP280_INCLUDE_WARM_START
+/*calibration and ctrl_meas/config in two burst reads, instead of a reset and a full configuration*/
+static bmp280_error_code_t bmp280_adopt_or_cold_start(
 	bmp280_handle_t *handle,
-	bmp280_over_sampling_t *tempOS)
+	bmp280_warm_start_cache_t *cache)
 {
-	uint8_t readOS;
+	uint8_t data[BMP280_CALIBRATION_DATA_LENGTH];
+	uint8_t control[2];
+	bmp280_calibration_param_t dig;
 	bmp280_error_code_t error;
+	uint8_t matches = 0;
+	uint8_t mode_mask = 0xFF;
 
-	error = bmp280_get_bits_in_register(handle, BMP280_REGISTER_ADDRESS_CONTROL_MEAS, &readOS, BMP280_REGISTER_BIT_OSRS_T, BMP280_REGISTER_FIELD_LENGTH_OSRS_T);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
-
-	if (readOS > BMP280_OVERSAMPLING_16X)
+	BMP280_LOCK(handle);
+	error = bmp280_read_registers(handle, BMP280_REGISTER_ADDRESS_T1, data, BMP280_CALIBRATION_DATA_LENGTH);
+	if (error == BMP280_ERROR_OK)
 	{
-		*tempOS = BMP280_OVERSAMPLING_16X;
+		error = bmp280_read_registers(handle, BMP280_REGISTER_ADDRESS_CONTROL_MEAS, control, 2);
 	}
-	else
+	if (error == BMP280_ERROR_OK)
 	{
-		*tempOS = (bmp280_over_sampling_t)readOS;
-	}
-
-	return BMP280_ERROR_OK;
-}
+		bmp280_decode_calibration(data, &dig);
 
-/*returns the current pressure oversampling*/
-bmp280_error_code_t bmp280_get_pressure_oversampling(
-	bmp280_handle_t *handle,
-	bmp280_over_sampling_t *pressureOS)
-{
-	uint8_t readOS;
-	bmp280_error_code_t error;
+		/*a forced mode sensor is back in sleep mode after each conversion*/
+		if (cache != NULL && (cache->ctrl_meas & 0x03) != BMP280_MODE_NORMAL && (cache->ctrl_meas & 0x03) != BMP280_MODE_SLEEP)
+		{
+			mode_mask = 0xFC;
+		}
 
-	error = bmp280_get_bits_in_register(handle, BMP280_REGISTER_ADDRESS_CONTROL_MEAS, &readOS, BMP280_REGISTER_BIT_OSRS_P, BMP280_REGISTER_FIELD_LENGTH_OSRS_P);
+		matches = (cache != NULL &&
+			cache->calibration_hash == bmp280_calibration_hash(&cache->dig) &&
+			cache->calibration_hash == bmp280_calibration_hash(&dig) &&
+			((cache->ctrl_meas ^ control[0]) & mode_mask) == 0 &&
+			cache->config == control[1]);
+	}
+	if (matches)
+	{
+		/*the sensor kept running with the cached state; adopt it, with the mode of the cache*/
+		handle->dig = dig;
+		handle->ctrl_meas = cache->ctrl_meas;
+		handle->config = control[1];
+		handle->operation_mode = ((cache->ctrl_meas & 0x03) == BMP280_MODE_NORMAL) ? BMP280_MODE_NORMAL : (((cache->ctrl_meas & 0x03) == BMP280_MODE_SLEEP) ? BMP280_MODE_SLEEP : BMP280_MODE_FORCED);
+	}
+	BMP280_UNLOCK(handle);
 	BMP280_CHECK_AND_RETURN_ERROR(error);
 
-	if (readOS > BMP280_OVERSAMPLING_16X)
+	if (matches)
 	{
-		*pressureOS = BMP280_OVERSAMPLING_16X;
+		return BMP280_ERROR_OK;
 	}
-	else
+
+	error = bmp280_cold_start(handle);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
+
+	if (cache != NULL)
 	{
-		*pressureOS = (bmp280_over_sampling_t)readOS;
+		BMP280_LOCK(handle);
+		error = bmp280_fill_warm_start_cache(handle, cache);
+		BMP280_UNLOCK(handle);
 	}
 
-	return BMP280_ERROR_OK;
+	return error;
 }
 
-/*returns the current standby time (for normal mode)*/
-bmp280_error_code_t bmp280_get_standby_time(
+/*reads ctrl_meas/config back from the sensor and stores them with the calibration*/
+static bmp280_error_code_t bmp280_fill_warm_start_cache(
 	bmp280_handle_t *handle,
-	bmp280_standby_time_t *standby_time)
+	bmp280_warm_start_cache_t *cache)
 {
-	uint8_t readTime;
-	bmp280_error_code_t error;
-
-	error = bmp280_get_bits_in_register(handle, BMP280_REGISTER_ADDRESS_CONFIG, &readTime, BMP280_REGISTER_BIT_T_SB, BMP280_REGISTER_FIELD_LENGTH_T_SB);
+	uint8_t control[2];
+	bmp280_error_code_t error = bmp280_read_registers(handle, BMP280_REGISTER_ADDRESS_CONTROL_MEAS, control, 2);
 	BMP280_CHECK_AND_RETURN_ERROR(error);
 
-	*standby_time = (bmp280_standby_time_t)readTime;
+	cache->dig = handle->dig;
+	/*the register of a forced mode sensor reads sleep mode once a conversion is over; the cache keeps it forced*/
+	cache->ctrl_meas = (handle->operation_mode == BMP280_MODE_FORCED) ? (uint8_t)((control[0] & 0xFC) | BMP280_MODE_FORCED) : control[0];
+	cache->config = control[1];
+	cache->calibration_hash = bmp280_calibration_hash(&handle->dig);
 
 	return BMP280_ERROR_OK;
 }
+#endif
 
-/*returns the current IIR filter coefficient*/
-bmp280_error_code_t bmp280_get_filter_coefficient(
-	bmp280_handle_t *handle,
-	bmp280_iir_filter_t *filter_coeff)
+/*config writes can be ignored outside sleep mode: ctrl_meas goes to sleep mode first*/
+static bmp280_error_code_t bmp280_restore_registers(bmp280_handle_t *handle)
 {
-	uint8_t readFilter;
+	uint8_t ctrl_meas = handle->ctrl_meas;
+	uint8_t config = handle->config;
 	bmp280_error_code_t error;
 
-	error = bmp280_get_bits_in_register(handle, BMP280_REGISTER_ADDRESS_CONFIG, &readFilter, BMP280_REGISTER_BIT_FILTER, BMP280_REGISTER_FIELD_LENGTH_FILTER);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
-
-	if(readFilter > (int) BMP280_FILTER_16X)
+	error = bmp280_write_register(handle, BMP280_REGISTER_ADDRESS_CONTROL_MEAS, (uint8_t)(ctrl_meas & 0xFC));
+	if (error == BMP280_ERROR_OK)
 	{
-		return BMP280_ERROR_FILTER_COEFF_UNKNOWN;
+		error = bmp280_write_register(handle, BMP280_REGISTER_ADDRESS_CONFIG, config);
+	}
+	if (error == BMP280_ERROR_OK)
+	{
+		error = bmp280_write_register(handle, BMP280_REGISTER_ADDRESS_CONTROL_MEAS, ctrl_meas);
 	}
 
-	*filter_coeff = (bmp280_iir_filter_t)readFilter;
-
-	return BMP280_ERROR_OK;
+	return error;
 }
 
-#endif
-
-/*raw reading of temperature registers, uncompensated*/
-static bmp280_error_code_t bmp280_raw_temperature_data(bmp280_handle_t *handle, int32_t *raw_data)
+/*soft resets bm280 using special reset register*/
+static bmp280_error_code_t bmp280_soft_reset(bmp280_handle_t *handle)
 {
-	uint8_t temp[3];
-
-	/*reset the timeout value before the loop*/
-	handle->poll_timeout_ms = BMP280_MEASURING_POLL_TIMEOUT_IN_MS;
-
-	/*Polling and waiting for new data with a timeout*/
-	for( uint8_t measuring_status = BMP280_MEASURING_IN_PROGRESS; measuring_status == BMP280_MEASURING_IN_PROGRESS; )
-	{
-		bmp280_error_code_t error;
+	bmp280_error_code_t error;
 
-		error = bmp280_get_bits_in_register(handle, BMP280_REGISTER_ADDRESS_STATUS, &measuring_status, BMP280_REGISTER_BIT_MEASURING, BMP280_REGISTER_FIELD_LENGTH_MEASURING);
-		BMP280_CHECK_AND_RETURN_ERROR(error);
+	BMP280_LOCK(handle);
+	error = bmp280_write_register(handle, BMP280_REGISTER_ADDRESS_RESET, BMP280_RESET_VALUE);
+	handle->operation_mode = BMP280_MODE_SLEEP;
+	BMP280_UNLOCK(handle);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
 
-		if(measuring_status == BMP280_MEASURING_IN_PROGRESS)
-		{
-			if(handle->poll_timeout_ms < BMP280_MEASURING_POLL_PERIOD_IN_MS)
-			{
-				return BMP280_ERROR_SENSOR_POLL_TIMEOUT;
-			}
+	return bmp280_delay_until(handle, bmp280_now_us(handle), (uint32_t)BMP280_STARTUP_DELAY_IN_MS * 1000);
+}
 
-			handle->poll_timeout_ms -= BMP280_MEASURING_POLL_PERIOD_IN_MS;
+/*checks chip id to see if it really is a bmp280 module with correct wiring and address*/
+static bmp280_error_code_t bmp280_read_chip_id(bmp280_handle_t *handle)
+{
+	uint8_t data;
+	bmp280_error_code_t error = bmp280_read_registers(handle, BMP280_REGISTER_ADDRESS_ID, &data, 1);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
 
-			if(handle->dependency_interface.bmp280_delay_function(BMP280_MEASURING_POLL_PERIOD_IN_MS) != 0)
-			{
-				return BMP280_ERROR_INTERFACE_DELAY;
-			}
-		}
-	}
+	return (data == BMP280_DEFAULT_CHIP_ID) ? BMP280_ERROR_OK : BMP280_ERROR_SENSOR_ID;
+}
 
+/*setting bmp280 mode, NORMAL_MODE, FORCED_MODE, SLEEP_MODE*/
+static bmp280_error_code_t bmp280_write_mode(
+	bmp280_handle_t *handle,
+	bmp280_operation_mode_t operationMode)
+{
+	bmp280_error_code_t error;
 
 	BMP280_LOCK(handle);
-	if (handle->dependency_interface.bmp280_read_array(handle->i2c_address, BMP280_REGISTER_ADDRESS_TEMPERATURE_MSB, temp, 3) != 0)
+	error = bmp280_set_bits_in_register(handle, BMP280_REGISTER_ADDRESS_CONTROL_MEAS, operationMode, BMP280_REGISTER_BIT_MODE, BMP280_REGISTER_FIELD_LENGTH_MODE);
+	if (error == BMP280_ERROR_OK)
 	{
-		BMP280_UNLOCK(handle);
-		return BMP280_ERROR_INTERFACE_READ;
+		handle->operation_mode = operationMode;
 	}
 	BMP280_UNLOCK(handle);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
 
-	*raw_data = (int32_t)((((uint32_t)temp[0]) << 12) + (((uint32_t)temp[1]) << 4) + (((uint32_t)temp[2]) >> 4));
-
-	return BMP280_ERROR_OK;
+	return bmp280_delay_until(handle, bmp280_now_us(handle), 50000);
 }
 
-/*raw reading of pressure registers, uncompensated*/
-static bmp280_error_code_t bmp280_raw_pressure_data(bmp280_handle_t *handle, int32_t *raw_data)
+/*In order to change configuration, the BMP280 sensor must be in SLEEP mode*/
+static bmp280_error_code_t bmp280_set_field_in_sleep(
+	bmp280_handle_t *handle,
+	bmp280_register_address_t registerAddress,
+	uint8_t fieldData,
+	bmp280_register_bit_t fieldStartBitAddress,
+	bmp280_register_field_length_t fieldLength)
 {
-	uint8_t pressure[3];
-
-	/*reset the timeout value before the loop*/
-	handle->poll_timeout_ms = BMP280_MEASURING_POLL_TIMEOUT_IN_MS;
-
-	/*Polling and waiting for new data with a timeout*/
-	for( uint8_t measuring_status = BMP280_MEASURING_IN_PROGRESS; measuring_status == BMP280_MEASURING_IN_PROGRESS; )
-	{
-		bmp280_error_code_t error;
-
-		error = bmp280_get_bits_in_register(handle, BMP280_REGISTER_ADDRESS_STATUS, &measuring_status, BMP280_REGISTER_BIT_MEASURING, BMP280_REGISTER_FIELD_LENGTH_MEASURING);
-		BMP280_CHECK_AND_RETURN_ERROR(error);
-
-		if(measuring_status == BMP280_MEASURING_IN_PROGRESS)
-		{
-			if(handle->poll_timeout_ms < BMP280_MEASURING_POLL_PERIOD_IN_MS)
-			{
-				return BMP280_ERROR_SENSOR_POLL_TIMEOUT;
-			}
-
-			handle->poll_timeout_ms -= BMP280_MEASURING_POLL_PERIOD_IN_MS;
+	bmp280_operation_mode_t operation_mode = handle->operation_mode;
 
-			if(handle->dependency_interface.bmp280_delay_function(BMP280_MEASURING_POLL_PERIOD_IN_MS) != 0)
-			{
-				return BMP280_ERROR_INTERFACE_DELAY;
-			}
-		}
-	}
-	
-	handle->poll_timeout_ms = BMP280_MEASURING_POLL_TIMEOUT_IN_MS;
+	bmp280_error_code_t error = bmp280_write_mode(handle, BMP280_MODE_SLEEP);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
 
 	BMP280_LOCK(handle);
-	if (handle->dependency_interface.bmp280_read_array(handle->i2c_address, BMP280_REGISTER_ADDRESS_PRESSURE_MSB, pressure, 3) != 0)
-	{
-		BMP280_UNLOCK(handle);
-		return BMP280_ERROR_INTERFACE_READ;
-	}
+	error = bmp280_set_bits_in_register(handle, registerAddress, fieldData, fieldStartBitAddress, fieldLength);
 	BMP280_UNLOCK(handle);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
 
-	*raw_data = (int32_t)((((uint32_t)pressure[0]) << 12) + (((uint32_t)pressure[1]) << 4) + (((uint32_t)pressure[2]) >> 4));
-
-	return BMP280_ERROR_OK;
+	return bmp280_write_mode(handle, operation_mode);
 }
 
-/*extracting calibration data in chip's "non volatile memory". we need to do this only once for each chip*/
-static bmp280_error_code_t bmp280_get_calibration(bmp280_handle_t *handle)
+/*config first, then ctrl_meas with the mode; a running sensor is put to sleep before config is written*/
+static bmp280_error_code_t bmp280_write_settings(
+	bmp280_handle_t *handle,
+	const bmp280_settings_t *settings)
 {
-	int16_t result_signed;
-	uint16_t result_unsigned;
-
+	uint8_t config = ((uint8_t)settings->standby_time << BMP280_REGISTER_BIT_T_SB) | ((uint8_t)settings->filter_coefficient << BMP280_REGISTER_BIT_FILTER);
+	uint8_t ctrl_meas = ((uint8_t)settings->temperature_oversampling << BMP280_REGISTER_BIT_OSRS_T) | ((uint8_t)settings->pressure_oversampling << BMP280_REGISTER_BIT_OSRS_P);
 	bmp280_error_code_t error;
 
-	/*Getting calibration data byte by byte and saving it to the handle*/
-	error = bmp280_read_calibration_word_unsigned(handle, BMP280_REGISTER_ADDRESS_T1, &result_unsigned);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
-	handle->dig.T1 = result_unsigned;
+	if (handle->operation_mode != BMP280_MODE_SLEEP)
+	{
+		error = bmp280_write_register(handle, BMP280_REGISTER_ADDRESS_CONTROL_MEAS, ctrl_meas | ((uint8_t)BMP280_MODE_SLEEP << BMP280_REGISTER_BIT_MODE));
+		BMP280_CHECK_AND_RETURN_ERROR(error);
 
-	error = bmp280_read_calibration_word_signed(handle, BMP280_REGISTER_ADDRESS_T2, &result_signed);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
-	handle->dig.T2 = result_signed;
+		handle->operation_mode = BMP280_MODE_SLEEP;
+	}
 
-	error = bmp280_read_calibration_word_signed(handle, BMP280_REGISTER_ADDRESS_T3, &result_signed);
+	error = bmp280_write_register(handle, BMP280_REGISTER_ADDRESS_CONFIG, config);
 	BMP280_CHECK_AND_RETURN_ERROR(error);
-	handle->dig.T3 = result_signed;
 
-	error = bmp280_read_calibration_word_unsigned(handle, BMP280_REGISTER_ADDRESS_P1, &result_unsigned);
+	error = bmp280_write_register(handle, BMP280_REGISTER_ADDRESS_CONTROL_MEAS, ctrl_meas | ((uint8_t)settings->operation_mode << BMP280_REGISTER_BIT_MODE));
 	BMP280_CHECK_AND_RETURN_ERROR(error);
-	handle->dig.P1 = result_unsigned;
 
-	error = bmp280_read_calibration_word_signed(handle, BMP280_REGISTER_ADDRESS_P2, &result_signed);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
-	handle->dig.P2 = result_signed;
+	handle->operation_mode = settings->operation_mode;
 
-	error = bmp280_read_calibration_word_signed(handle, BMP280_REGISTER_ADDRESS_P3, &result_signed);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
-	handle->dig.P3 = result_signed;
+	return BMP280_ERROR_OK;
+}
 
-	error = bmp280_read_calibration_word_signed(handle, BMP280_REGISTER_ADDRESS_P4, &result_signed);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
-	handle->dig.P4 = result_signed;
+/*after a reset the sensor sleeps, so config and ctrl_meas take one write each, with no mode changes in between*/
+static bmp280_error_code_t bmp280_write_default_configuration(bmp280_handle_t *handle)
+{
+	uint8_t config = ((uint8_t)BMP280_STANDBY_TIME_DEFAULT << BMP280_REGISTER_BIT_T_SB) | ((uint8_t)BMP280_FILTER_DEFAULT << BMP280_REGISTER_BIT_FILTER);
+	uint8_t ctrl_meas = ((uint8_t)BMP280_TEMPERATURE_OVERSAMPLING_DEFAULT << BMP280_REGISTER_BIT_OSRS_T) | ((uint8_t)BMP280_PRESSURE_OVERSAMPLING_DEFAULT << BMP280_REGISTER_BIT_OSRS_P) | ((uint8_t)BMP280_MODE_DEFAULT << BMP280_REGISTER_BIT_MODE);
 
-	error = bmp280_read_calibration_word_signed(handle, BMP280_REGISTER_ADDRESS_P5, &result_signed);
+	bmp280_error_code_t error = bmp280_write_register(handle, BMP280_REGISTER_ADDRESS_CONFIG, config);
 	BMP280_CHECK_AND_RETURN_ERROR(error);
-	handle->dig.P5 = result_signed;
 
-	error = bmp280_read_calibration_word_signed(handle, BMP280_REGISTER_ADDRESS_P6, &result_signed);
+	error = bmp280_write_register(handle, BMP280_REGISTER_ADDRESS_CONTROL_MEAS, ctrl_meas);
 	BMP280_CHECK_AND_RETURN_ERROR(error);
-	handle->dig.P6 = result_signed;
 
-	error = bmp280_read_calibration_word_signed(handle, BMP280_REGISTER_ADDRESS_P7, &result_signed);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
-	handle->dig.P7 = result_signed;
+	handle->operation_mode = BMP280_MODE_DEFAULT;
 
-	error = bmp280_read_calibration_word_signed(handle, BMP280_REGISTER_ADDRESS_P8, &result_signed);
-	BMP280_CHECK_AND_RETURN_ERROR(error);
-	handle->dig.P8 = result_signed;
+	return BMP280_ERROR_OK;
+}
 
-	error = bmp280_read_calibration_word_signed(handle, BMP280_REGISTER_ADDRESS_P9, &result_signed);
+/*extracting calibration data in chip's "non volatile memory". we need to do this only once for each chip*/
+static bmp280_error_code_t bmp280_get_calibration(bmp280_handle_t *handle)
+{
+	uint8_t data[BMP280_CALIBRATION_DATA_LENGTH];
+
+	/*Getting all calibration words in one burst read and saving them to the handle*/
+	bmp280_error_code_t error = bmp280_read_registers(handle, BMP280_REGISTER_ADDRESS_T1, data, BMP280_CALIBRATION_DATA_LENGTH);
 	BMP280_CHECK_AND_RETURN_ERROR(error);
-	handle->dig.P9 = result_signed;
+
+	bmp280_decode_calibration(data, &handle->dig);
 
 	return BMP280_ERROR_OK;
 }
 
-/*only used in get_calibration function*/
-static bmp280_error_code_t bmp280_read_calibration_word_unsigned(
-	bmp280_handle_t *handle, 
-	bmp280_register_address_t startRegisterAddress, 
-	uint16_t *result)
+/*turns the little endian calibration words into calibration parameters*/
+static void bmp280_decode_calibration(const uint8_t *data, bmp280_calibration_param_t *dig)
 {
-	uint8_t data[2];
+	dig->T1 = (uint16_t)((((uint16_t)data[1]) << 8) + (uint16_t)data[0]);
+	dig->T2 = (int16_t)((((uint16_t)data[3]) << 8) + (uint16_t)data[2]);
+	dig->T3 = (int16_t)((((uint16_t)data[5]) << 8) + (uint16_t)data[4]);
+	dig->P1 = (uint16_t)((((uint16_t)data[7]) << 8) + (uint16_t)data[6]);
+	dig->P2 = (int16_t)((((uint16_t)data[9]) << 8) + (uint16_t)data[8]);
+	dig->P3 = (int16_t)((((uint16_t)data[11]) << 8) + (uint16_t)data[10]);
+	dig->P4 = (int16_t)((((uint16_t)data[13]) << 8) + (uint16_t)data[12]);
+	dig->P5 = (int16_t)((((uint16_t)data[15]) << 8) + (uint16_t)data[14]);
+	dig->P6 = (int16_t)((((uint16_t)data[17]) << 8) + (uint16_t)data[16]);
+	dig->P7 = (int16_t)((((uint16_t)data[19]) << 8) + (uint16_t)data[18]);
+	dig->P8 = (int16_t)((((uint16_t)data[21]) << 8) + (uint16_t)data[20]);
+	dig->P9 = (int16_t)((((uint16_t)data[23]) << 8) + (uint16_t)data[22]);
+}
 
-	BMP280_LOCK(handle);
-	if (handle->dependency_interface.bmp280_read_array(handle->i2c_address, (uint8_t)startRegisterAddress, data, 2) != 0)
+#if BMP280_INCLUDE_WARM_START
+/*FNV-1a hash of the calibration parameters, in their little endian register order*/
+static uint32_t bmp280_calibration_hash(const bmp280_calibration_param_t *dig)
+{
+	uint16_t words[12];
+	uint32_t hash = 2166136261UL;
+
+	words[0] = dig->T1;
+	words[1] = (uint16_t)dig->T2;
+	words[2] = (uint16_t)dig->T3;
+	words[3] = dig->P1;
+	words[4] = (uint16_t)dig->P2;
+	words[5] = (uint16_t)dig->P3;
+	words[6] = (uint16_t)dig->P4;
+	words[7] = (uint16_t)dig->P5;
+	words[8] = (uint16_t)dig->P6;
+	words[9] = (uint16_t)dig->P7;
+	words[10] = (uint16_t)dig->P8;
+	words[11] = (uint16_t)dig->P9;
+
+	for (uint8_t index = 0; index < 12; index++)
 	{
-		BMP280_UNLOCK(handle);
-		return BMP280_ERROR_INTERFACE_READ;
+		hash = (hash ^ (words[index] & 0xFF)) * 16777619UL;
+		hash = (hash ^ (words[index] >> 8)) * 16777619UL;
 	}
-	BMP280_UNLOCK(handle);
 
-	/*Turning two bytes of data in a two byte block of memory */
-	*result = (uint16_t)((((uint16_t)data[1]) << 8) + (uint16_t)data[0]);
-
-	return BMP280_ERROR_OK;
+	return hash;
 }
+#endif
 
-/*only used in get_calibration function*/
-static bmp280_error_code_t bmp280_read_calibration_word_signed(
+/*reads a block of consecutive registers. the caller holds the exclusion hook*/
+static bmp280_error_code_t bmp280_read_registers(
 	bmp280_handle_t *handle,
-	bmp280_register_address_t startRegisterAddress,
-	int16_t *result)
+	bmp280_register_address_t registerAddress,
+	uint8_t *data,
+	uint8_t length)
 {
-	uint8_t data[2];
+	#if BMP280_INCLUDE_SHARED_BUS
+	if (handle->bus != NULL)
+	{
+		return bmp280_bus_transfer(handle->bus, (uint8_t)handle->i2c_address, (uint8_t)registerAddress, data, length, 0);
+	}
+	#endif
 
-	BMP280_LOCK(handle);
-	if (handle->dependency_interface.bmp280_read_array(handle->i2c_address, (uint8_t)startRegisterAddress, data, 2) != 0)
+	if (handle->dependency_interface.bmp280_read_array(handle->i2c_address, (uint8_t)registerAddress, data, length) != 0)
 	{
-		BMP280_UNLOCK(handle);
 		return BMP280_ERROR_INTERFACE_READ;
 	}
-	BMP280_UNLOCK(handle);
 
-	/*Turning two bytes of data in a two byte block of memory */
-	*result = (int16_t)((((int16_t)data[1]) << 8) + (int16_t)data[0]);
+	return BMP280_ERROR_OK;
+}
+
+/*msb, lsb and the upper nibble of xlsb*/
+static int32_t bmp280_raw_20bit(const uint8_t *raw)
+{
+	return (int32_t)((((uint32_t)raw[0]) << 12) + (((uint32_t)raw[1]) << 4) + (((uint32_t)raw[2]) >> 4));
+}
+
+/*writes a whole register*/
+static bmp280_error_code_t bmp280_write_register(
+	bmp280_handle_t *handle, 
+	bmp280_register_address_t registerAddress, 
+	uint8_t value)
+{
+	#if BMP280_INCLUDE_SHARED_BUS
+	if (handle->bus != NULL)
+	{
+		bmp280_error_code_t error = bmp280_bus_transfer(handle->bus, (uint8_t)handle->i2c_address, (uint8_t)registerAddress, &value, 1, 1);
+		BMP280_CHECK_AND_RETURN_ERROR(error);
+	}
+	else
+	#endif
+	if (handle->dependency_interface.bmp280_write_array(handle->i2c_address, (uint8_t)registerAddress, &value, 1) != 0)
+	{
+		return BMP280_ERROR_INTERFACE_WRITE;
+	}
+
+	bmp280_update_shadow_register(handle, registerAddress, value);
 
 	return BMP280_ERROR_OK;
 }
 
+/*keeps the handle's copy of ctrl_meas and config in step with the sensor. a reset clears both*/
+static void bmp280_update_shadow_register(
+	bmp280_handle_t *handle, 
+	bmp280_register_address_t registerAddress, 
+	uint8_t value)
+{
+	/*a conversion started earlier may not match the new settings*/
+	handle->forced_pending = 0;
+
+	if (registerAddress == BMP280_REGISTER_ADDRESS_CONTROL_MEAS)
+	{
+		handle->ctrl_meas = value;
+	}
+	else if (registerAddress == BMP280_REGISTER_ADDRESS_CONFIG)
+	{
+		handle->config = value;
+	}
+	else if (registerAddress == BMP280_REGISTER_ADDRESS_RESET && value == BMP280_RESET_VALUE)
+	{
+		handle->ctrl_meas = 0;
+		handle->config = 0;
+	}
+}
+
 /*sets a field of bits in a register*/
 static bmp280_error_code_t bmp280_set_bits_in_register(
 	bmp280_handle_t *handle, 
@@ -795,25 +2635,14 @@ static bmp280_error_code_t bmp280_set_bits_in_register(
 	uint8_t newRegisterValue;
 
 	/*Reading the register of sensor, changing the needed bits, and transfering the new value to the register*/
-	/*Hold the lock in the read-modify-write process*/
-	BMP280_LOCK(handle);
-	if (handle->dependency_interface.bmp280_read_array(handle->i2c_address, (uint8_t)registerAddress, &currentRegisterValue, 1) != 0)
-	{
-		BMP280_UNLOCK(handle);
-		return BMP280_ERROR_INTERFACE_READ;
-	}
+	/*The caller holds the lock over the whole read-modify-write process*/
+	bmp280_error_code_t error = bmp280_read_registers(handle, registerAddress, &currentRegisterValue, 1);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
 
 	currentRegisterValue &= (((~0) << ((uint8_t)fieldStartBitAddress + (uint8_t)fieldLength)) | (~(~(0) << (uint8_t)fieldStartBitAddress)));
 	newRegisterValue = currentRegisterValue | (fieldData << (uint8_t)fieldStartBitAddress);
 
-	if (handle->dependency_interface.bmp280_write_array(handle->i2c_address, (uint8_t)registerAddress, &newRegisterValue, 1) != 0)
-	{
-		BMP280_UNLOCK(handle);
-		return BMP280_ERROR_INTERFACE_WRITE;
-	}
-	BMP280_UNLOCK(handle);
-
-	return BMP280_ERROR_OK;
+	return bmp280_write_register(handle, registerAddress, newRegisterValue);
 }
 
 /*gets a field of bits from a register*/
@@ -825,14 +2654,8 @@ static bmp280_error_code_t bmp280_get_bits_in_register(
 	bmp280_register_field_length_t fieldLength)
 {
 	uint8_t registerValue;
-
-	BMP280_LOCK(handle);
-	if (handle->dependency_interface.bmp280_read_array(handle->i2c_address, (uint8_t)registerAddress, &registerValue, 1) != 0)
-	{
-		BMP280_UNLOCK(handle);
-		return BMP280_ERROR_INTERFACE_READ;
-	}
-	BMP280_UNLOCK(handle);
+	bmp280_error_code_t error = bmp280_read_registers(handle, registerAddress, &registerValue, 1);
+	BMP280_CHECK_AND_RETURN_ERROR(error);
 
 	/*Saves bits in a byte of memory*/
 	registerValue &= ~(((~0) << ((uint8_t)fieldStartBitAddress + (uint8_t)fieldLength)) | (~(~(0) << (uint8_t)fieldStartBitAddress)));